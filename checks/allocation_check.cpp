@@ -0,0 +1,209 @@
+#include "inference_engine.h"
+#include "neural_network.h"
+#include "read_csv.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+//Checks that the hot loops stop allocating once warmed up. The global operator new is replaced with a counting one;
+//every case runs once to grow the per-thread buffers, then the allocations of the following steps must be zero.
+//The pool is sized to N_THREADS whatever the hardware, so the multi-threaded cases hand tasks to workers.
+//Training is measured as the difference between a run of one epoch and a run of 1 + EXTRA_EPOCHS epochs from the
+//same seeds, which leaves out what a call allocates up front (the normalized copy, the row order, the workspaces)
+//and counts only the minibatch steps of the extra epochs.
+//usage: allocation_check [training csv = ../neural_net/data_train_2.csv]
+//Returns 0 if no case allocated, 1 otherwise.
+
+namespace
+{
+    std::atomic<size_t> g_n_allocations{ 0 };
+
+    void* countedAllocate(const size_t size)
+    {
+        g_n_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* p{ std::malloc(size == 0 ? 1 : size) })
+            return p;
+        throw std::bad_alloc{};
+    }
+
+    void* countedAllocate(const size_t size, const std::align_val_t alignment)
+    {
+        g_n_allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t align{ static_cast<size_t>(alignment) };
+        size_t rounded_size{ (size + align - 1) / align * align };
+#if defined(_MSC_VER)
+        void* p{ _aligned_malloc(rounded_size == 0 ? align : rounded_size, align) };
+#else
+        void* p{ std::aligned_alloc(align, rounded_size == 0 ? align : rounded_size) };
+#endif
+        if (p)
+            return p;
+        throw std::bad_alloc{};
+    }
+
+    void alignedFree(void* p)
+    {
+#if defined(_MSC_VER)
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+//The array and nothrow forms forward to these by default
+void* operator new(size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return countedAllocate(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    alignedFree(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    alignedFree(p);
+}
+
+namespace
+{
+    constexpr size_t N_THREADS{ 4 };
+    constexpr unsigned int SEED{ 42 };
+    constexpr size_t BATCH_SIZE{ 1000 };
+    constexpr size_t EXTRA_EPOCHS{ 2 };
+    constexpr size_t N_CALLS{ 1000 };
+    //Which workers join a run depends on scheduling, and a workspace first used in the longer run is set up there,
+    //so a training case is repeated before it fails; an allocation per step shows up in every attempt
+    constexpr size_t N_ATTEMPTS{ 5 };
+
+    template <typename F>
+    size_t countAllocations(F&& f)
+    {
+        size_t before{ g_n_allocations.load() };
+        f();
+        return g_n_allocations.load() - before;
+    }
+
+    bool report(const std::string& name, const size_t n_steps, const size_t n_allocations)
+    {
+        std::cout << name << ": " << n_allocations << " allocations in " << n_steps << " steps after warm-up\n";
+        return n_allocations == 0;
+    }
+
+    bool checkTraining(const std::string& name, const Matrix& y, const Matrix& x, const size_t n_threads, const TrainingMode mode)
+    {
+        std::vector<size_t> layers{ x.nCol(), 20, 10, 5, y.nCol() };
+        auto trainEpochs = [&](const size_t epochs)
+        {
+            NeuralNet nn{ layers, ActivationFunction::tanh, ActivationFunction::identity, SEED };
+            return countAllocations([&] { nn.train(y, x, 0.01, BATCH_SIZE, epochs, 0.0005, n_threads, mode, SEED); });
+        };
+
+        trainEpochs(1);
+        size_t one_epoch{};
+        size_t more_epochs{};
+        for (size_t attempt{ 0 }; attempt < N_ATTEMPTS && (attempt == 0 || more_epochs != one_epoch); attempt++)
+        {
+            one_epoch = trainEpochs(1);
+            more_epochs = trainEpochs(1 + EXTRA_EPOCHS);
+        }
+
+        size_t n_steps{ EXTRA_EPOCHS * ((x.nRow() + BATCH_SIZE - 1) / BATCH_SIZE) };
+        if (more_epochs < one_epoch)
+        {
+            std::cout << name << ": " << one_epoch - more_epochs << " more allocations in 1 epoch than in " << 1 + EXTRA_EPOCHS << "\n";
+            return false;
+        }
+        return report(name, n_steps, more_epochs - one_epoch);
+    }
+
+    bool checkPredictOne(const NeuralNet& nn, const Matrix& x)
+    {
+        std::span<const double> row{ x.data(), x.nCol() };
+        std::vector<double> out(nn.layers().back());
+        std::vector<double> scratch(nn.predictOneScratchSize());
+
+        nn.predictOne(row, out);
+        nn.predictOne(row, out, scratch);
+        bool passed{ report("predictOne", N_CALLS, countAllocations([&]
+            {
+                for (size_t i{ 0 }; i < N_CALLS; i++)
+                {
+                    nn.predictOne(row, out);
+                }
+            })) };
+        passed &= report("predictOne with scratch", N_CALLS, countAllocations([&]
+            {
+                for (size_t i{ 0 }; i < N_CALLS; i++)
+                {
+                    nn.predictOne(row, out, scratch);
+                }
+            }));
+        return passed;
+    }
+
+    bool checkInferenceEngine(const NeuralNet& nn, const Matrix& x)
+    {
+        InferenceEngine engine{ nn, BATCH_SIZE };
+        std::span<const double> rows{ x.data(), BATCH_SIZE * x.nCol() };
+        std::vector<double> out(BATCH_SIZE * engine.nOutputs());
+
+        parallel::ThreadLimit thread_limit{ 1 };
+        engine.predict(rows, out);
+        return report("InferenceEngine::predict", N_CALLS, countAllocations([&]
+            {
+                for (size_t i{ 0 }; i < N_CALLS; i++)
+                {
+                    engine.predict(rows, out);
+                }
+            }));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    //Before anything touches the pool, which is sized on first use
+    parallel::setNumThreads(N_THREADS);
+    std::cout << "Pool workers: " << parallel::pool().nWorkers() << '\n';
+
+    std::string filename{ argc > 1 ? argv[1] : "../neural_net/data_train_2.csv" };
+    labeled_data data{ read_csv(filename, { 0 }, { 1, 2, 3 }) };
+    Matrix y{ std::move(data.y) };
+    Matrix x{ std::move(data.x) };
+
+    bool passed{ true };
+    passed &= checkTraining("serial, 1 thread", y, x, 1, TrainingMode::serial);
+    passed &= checkTraining("serial, 2 threads", y, x, 2, TrainingMode::serial);
+    passed &= checkTraining("data_parallel, 2 threads", y, x, 2, TrainingMode::data_parallel);
+    passed &= checkTraining("hogwild, 2 threads", y, x, 2, TrainingMode::hogwild);
+
+    NeuralNet nn{ { x.nCol(), 20, 10, 5, y.nCol() }, ActivationFunction::tanh, ActivationFunction::identity, SEED };
+    nn.train(y, x, 0.01, BATCH_SIZE, 1, 0.0005, 0, TrainingMode::serial, SEED);
+    passed &= checkPredictOne(nn, x);
+    passed &= checkInferenceEngine(nn, x);
+
+    std::cout << (passed ? "No allocations after warm-up\n" : "FAILED: allocations after warm-up\n");
+    return passed ? 0 : 1;
+}
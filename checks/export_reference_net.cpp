@@ -0,0 +1,47 @@
+#include "header_export.h"
+#include "neural_network.h"
+#include "read_csv.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+//Trains a seeded network on the training set and exports it twice, in double and in float precision, as
+//reference_net.h and reference_net_float.h with the first rows of the test set as reference rows.
+//header_export_check runs this before it compiles, so it can include the generated headers.
+//usage: export_reference_net <output directory> [training csv = ../neural_net/data_train_2.csv] [test csv = ../neural_net/data_test_2.csv]
+
+namespace
+{
+    constexpr unsigned int SEED{ 42 };
+    constexpr size_t N_REFERENCE_ROWS{ 100 };
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: export_reference_net <output directory> [training csv] [test csv]\n";
+        return 1;
+    }
+
+    std::filesystem::path directory{ argv[1] };
+    std::string train_filename{ argc > 2 ? argv[2] : "../neural_net/data_train_2.csv" };
+    std::string test_filename{ argc > 3 ? argv[3] : "../neural_net/data_test_2.csv" };
+
+    labeled_data data_train{ read_csv(train_filename, { 0 }, { 1, 2, 3 }) };
+    labeled_data data_test{ read_csv(test_filename, { 0 }, { 1, 2, 3 }) };
+    std::vector<size_t> reference_rows(std::min(N_REFERENCE_ROWS, data_test.x.nRow()));
+    std::iota(reference_rows.begin(), reference_rows.end(), size_t{ 0 });
+    Matrix reference_x{ data_test.x.getRows(reference_rows) };
+
+    NeuralNet nn{ { data_train.x.nCol(), 20, 10, 5, data_train.y.nCol() }, ActivationFunction::tanh, ActivationFunction::identity, SEED };
+    nn.train(data_train.y, data_train.x, 0.01, 1000, 10, 0.0005, 0, TrainingMode::serial, SEED);
+    FloatNeuralNet float_nn{ nn };
+
+    header_export::write(nn, reference_x, (directory / "reference_net.h").string(), "reference_net");
+    header_export::write(float_nn, FloatMatrix{ reference_x }, (directory / "reference_net_float.h").string(), "reference_net_float");
+    return 0;
+}
@@ -0,0 +1,28 @@
+#include "reference_net.h"
+#include "reference_net_float.h"
+#include <iostream>
+
+//Checks exported headers against the network they came from. reference_net.h and reference_net_float.h are written
+//by export_reference_net before this is compiled; each header reruns its reference rows through the generated
+//predict, and the largest difference from NeuralNet::predict must stay within the tolerance of its precision.
+//Returns 0 if both headers are within tolerance, 1 otherwise.
+
+namespace
+{
+    //The headers use the accurate approximations of the library's activation kernels, so the differences are at rounding
+    //level; the tolerances leave room for other compilers and instruction sets
+    constexpr double DOUBLE_TOLERANCE{ 1e-9 };
+    constexpr float FLOAT_TOLERANCE{ 1e-4f };
+}
+
+int main()
+{
+    double double_error{ reference_net::maxReferenceError() };
+    float float_error{ reference_net_float::maxReferenceError() };
+    std::cout << "double: largest difference " << double_error << " (tolerance " << DOUBLE_TOLERANCE << ")\n";
+    std::cout << "float: largest difference " << float_error << " (tolerance " << FLOAT_TOLERANCE << ")\n";
+
+    bool passed{ double_error <= DOUBLE_TOLERANCE && float_error <= FLOAT_TOLERANCE };
+    std::cout << (passed ? "Exported headers match the network\n" : "FAILED: exported headers differ from the network\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include "protocol.h"
+#include "unix_socket.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Drives an inference server with concurrent clients, one request in flight per connection, and reports throughput and
+//latency percentiles.
+//usage: load_generator <socket path> <features per row> [connections = 16] [requests per connection = 2000] [rows per request = 1]
+
+namespace
+{
+    struct ClientResult
+    {
+        std::vector<double> latencies_us{};
+        size_t n_failed{};
+    };
+
+    void runClient(const std::string& path, const size_t n_features, const size_t n_requests, const size_t n_rows, const unsigned int seed, ClientResult& result)
+    {
+        try
+        {
+            ipc::UnixSocket connection{ ipc::UnixSocket::connect(path) };
+            std::mt19937 generator{ seed };
+            std::normal_distribution<double> distribution{ 0.0, 1.0 };
+            std::vector<double> x(n_rows * n_features);
+            std::vector<double> out{};
+            result.latencies_us.reserve(n_requests);
+
+            protocol::RequestHeader request{ static_cast<std::uint32_t>(n_rows), static_cast<std::uint32_t>(n_features) };
+            for (size_t i{ 0 }; i < n_requests; i++)
+            {
+                for (double& value : x)
+                {
+                    value = distribution(generator);
+                }
+
+                std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+                connection.writeAll(&request, sizeof(request));
+                connection.writeAll(x.data(), x.size() * sizeof(double));
+                protocol::ResponseHeader response{};
+                if (!connection.readAll(&response, sizeof(response)) || response.status != protocol::Status::ok)
+                {
+                    result.n_failed += n_requests - i;
+                    return;
+                }
+                out.resize(response.n_values);
+                connection.readAll(out.data(), out.size() * sizeof(double));
+                result.latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+            result.n_failed += n_requests - result.latencies_us.size();
+        }
+    }
+
+    double percentile(const std::vector<double>& sorted, const double fraction)
+    {
+        return sorted[static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1))];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: load_generator <socket path> <features per row> [connections = 16] [requests per connection = 2000] [rows per request = 1]\n";
+        return 1;
+    }
+
+    std::string path{ argv[1] };
+    size_t n_features{ std::stoul(argv[2]) };
+    size_t n_connections{ argc > 3 ? std::stoul(argv[3]) : 16 };
+    size_t n_requests{ argc > 4 ? std::stoul(argv[4]) : 2000 };
+    size_t n_rows{ argc > 5 ? std::stoul(argv[5]) : 1 };
+
+    std::vector<ClientResult> results(n_connections);
+    std::vector<std::thread> clients{};
+    std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+    for (size_t i{ 0 }; i < n_connections; i++)
+    {
+        clients.emplace_back(runClient, std::cref(path), n_features, n_requests, n_rows, static_cast<unsigned int>(i), std::ref(results[i]));
+    }
+    for (std::thread& client : clients)
+    {
+        client.join();
+    }
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    std::vector<double> latencies{};
+    size_t n_failed{ 0 };
+    for (const ClientResult& result : results)
+    {
+        latencies.insert(latencies.end(), result.latencies_us.begin(), result.latencies_us.end());
+        n_failed += result.n_failed;
+    }
+    if (latencies.empty())
+    {
+        std::cerr << "No request succeeded\n";
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << latencies.size() << " requests (" << n_failed << " failed) from " << n_connections << " connections in " << seconds << " s\n"
+        << static_cast<double>(latencies.size()) / seconds << " requests/s, " << static_cast<double>(latencies.size() * n_rows) / seconds << " rows/s\n"
+        << "latency us: p50 " << percentile(latencies, 0.5) << ", p90 " << percentile(latencies, 0.9) << ", p99 " << percentile(latencies, 0.99)
+        << ", p99.9 " << percentile(latencies, 0.999) << ", max " << latencies.back() << '\n';
+    return 0;
+}
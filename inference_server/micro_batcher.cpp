@@ -0,0 +1,136 @@
+#include "micro_batcher.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+MicroBatcher::MicroBatcher(const NeuralNet& net, const size_t max_batch, const std::chrono::microseconds max_wait, const size_t n_workers)
+    : m_model{ net }, m_max_batch{ max_batch }, m_max_wait{ max_wait }
+{
+    if (max_batch == 0 || n_workers == 0)
+        throw std::invalid_argument("Need a positive batch size and worker count!");
+
+    for (size_t i{ 0 }; i < n_workers; i++)
+    {
+        m_workers.emplace_back(&MicroBatcher::work, this);
+    }
+}
+
+MicroBatcher::~MicroBatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_stopping = true;
+    }
+    m_work_ready.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+size_t MicroBatcher::nInputs() const
+{
+    return m_model.nInputs();
+}
+
+size_t MicroBatcher::nOutputs() const
+{
+    return m_model.nOutputs();
+}
+
+size_t MicroBatcher::nBatches() const
+{
+    return m_n_batches.load(std::memory_order_relaxed);
+}
+
+size_t MicroBatcher::nRows() const
+{
+    return m_n_rows.load(std::memory_order_relaxed);
+}
+
+void MicroBatcher::score(std::span<const double> x, std::span<double> out)
+{
+    size_t n_rows{ x.size() / nInputs() };
+    if (x.size() % nInputs() != 0 || out.size() != n_rows * nOutputs())
+        throw std::invalid_argument("Input and output sizes do not match the network!");
+    if (n_rows == 0)
+        return;
+
+    Pending pending{ x, out, n_rows, std::chrono::steady_clock::now() };
+    std::unique_lock<std::mutex> lock{ m_mutex };
+    if (m_stopping)
+        throw std::invalid_argument("Batcher is shutting down!");
+
+    m_queue.push_back(&pending);
+    m_queued_rows += n_rows;
+    m_work_ready.notify_one();
+    pending.finished.wait(lock, [&] { return pending.done; });
+}
+
+void MicroBatcher::work()
+{
+    //Workers are the parallelism, so each engine's matrix products stay on its own thread
+    parallel::ThreadLimit serial{ 1 };
+    InferenceEngine engine{ m_model, m_max_batch };
+    std::vector<double> batch_x(m_max_batch * nInputs());
+    std::vector<double> batch_out(m_max_batch * nOutputs());
+    std::vector<Pending*> batch{};
+
+    std::unique_lock<std::mutex> lock{ m_mutex };
+    while (true)
+    {
+        m_work_ready.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty())
+            return;
+
+        //Hold the batch open until it is full or its oldest request has waited max_wait
+        std::chrono::steady_clock::time_point deadline{ m_queue.front()->arrival + m_max_wait };
+        m_work_ready.wait_until(lock, deadline, [&] { return m_stopping || m_queue.empty() || m_queued_rows >= m_max_batch; });
+        //Another worker may have taken them meanwhile
+        if (m_queue.empty())
+            continue;
+
+        batch.clear();
+        size_t n_rows{ 0 };
+        do
+        {
+            batch.push_back(m_queue.front());
+            n_rows += m_queue.front()->n_rows;
+            m_queue.pop_front();
+        } while (!m_queue.empty() && n_rows + m_queue.front()->n_rows <= m_max_batch);
+        m_queued_rows -= n_rows;
+        if (!m_queue.empty())
+            m_work_ready.notify_one();
+        lock.unlock();
+
+        if (batch.size() == 1)
+        {
+            engine.predict(batch[0]->x, batch[0]->out);
+        }
+        else
+        {
+            //Gather the requests' rows into one batch and scatter the outputs back
+            double* x{ batch_x.data() };
+            for (const Pending* pending : batch)
+            {
+                x = std::copy(pending->x.begin(), pending->x.end(), x);
+            }
+            engine.predict(std::span<const double>{ batch_x.data(), n_rows * nInputs() }, std::span<double>{ batch_out.data(), n_rows * nOutputs() });
+            const double* out{ batch_out.data() };
+            for (const Pending* pending : batch)
+            {
+                std::copy(out, out + pending->out.size(), pending->out.begin());
+                out += pending->out.size();
+            }
+        }
+        m_n_batches.fetch_add(1, std::memory_order_relaxed);
+        m_n_rows.fetch_add(n_rows, std::memory_order_relaxed);
+
+        lock.lock();
+        for (Pending* pending : batch)
+        {
+            pending->done = true;
+            pending->finished.notify_one();
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "inference_engine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+//Coalesces concurrent scoring requests into micro-batches for InferenceEngine.
+//Callers block in score() until their rows are done. Each worker thread owns an engine and takes queued requests in
+//arrival order until they fill max_batch rows, holding a batch open for at most max_wait after its oldest request
+//arrived. A request larger than max_batch runs as a batch of its own.
+class MicroBatcher
+{
+private:
+    struct Pending
+    {
+        std::span<const double> x{};
+        std::span<double> out{};
+        size_t n_rows{};
+        std::chrono::steady_clock::time_point arrival{};
+        bool done{};
+        std::condition_variable finished{};
+    };
+
+    FrozenNet m_model;
+    size_t m_max_batch{};
+    std::chrono::microseconds m_max_wait{};
+
+    std::mutex m_mutex{};
+    std::condition_variable m_work_ready{};
+    std::deque<Pending*> m_queue{};
+    size_t m_queued_rows{};
+    bool m_stopping{};
+    std::vector<std::thread> m_workers{};
+
+    std::atomic<size_t> m_n_batches{};
+    std::atomic<size_t> m_n_rows{};
+
+    void work();
+
+public:
+    MicroBatcher(const NeuralNet& net, const size_t max_batch, const std::chrono::microseconds max_wait, const size_t n_workers);
+    //Finishes the queued requests, then stops the workers
+    ~MicroBatcher();
+    MicroBatcher(const MicroBatcher&) = delete;
+    MicroBatcher& operator=(const MicroBatcher&) = delete;
+
+    size_t nInputs() const;
+    size_t nOutputs() const;
+    //x holds whole rows of nInputs() raw features; out receives nOutputs() values per row
+    void score(std::span<const double> x, std::span<double> out);
+    //Totals since construction
+    size_t nBatches() const;
+    size_t nRows() const;
+};
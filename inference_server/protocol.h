@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+//Framing between the inference server and its clients. Both ends share a machine, so integers and doubles travel in
+//native byte order.
+//A request is a RequestHeader followed by n_rows * n_features raw feature values, row-major, as doubles.
+//The reply is a ResponseHeader followed by n_values doubles, the model's outputs row by row, when the status is ok.
+//Requests on one connection are answered in the order they were sent.
+namespace protocol
+{
+    enum class Status : std::uint32_t
+    {
+        ok,
+        bad_request
+    };
+
+    struct RequestHeader
+    {
+        std::uint32_t n_rows{};
+        std::uint32_t n_features{};
+    };
+
+    struct ResponseHeader
+    {
+        Status status{};
+        std::uint32_t n_values{};
+    };
+
+    //Bounds what one request makes the server allocate
+    constexpr std::uint32_t MAX_REQUEST_VALUES{ 1u << 24 };
+}
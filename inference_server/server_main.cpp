@@ -0,0 +1,116 @@
+#include "micro_batcher.h"
+#include "protocol.h"
+#include "unix_socket.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Serves a saved NeuralNet over a Unix domain socket (framing in protocol.h), batching concurrent requests.
+//usage: inference_server <model file> <socket path> [max batch rows = 256] [max wait in microseconds = 200] [workers = hardware threads]
+
+namespace
+{
+    void serveConnection(ipc::UnixSocket connection, MicroBatcher& batcher)
+    {
+        std::vector<double> x{};
+        std::vector<double> out{};
+        try
+        {
+            protocol::RequestHeader request{};
+            while (connection.readAll(&request, sizeof(request)))
+            {
+                size_t n_values{ static_cast<size_t>(request.n_rows) * request.n_features };
+                //The rest of the stream can't be trusted after a bad header, so the connection ends with the reply
+                if (request.n_features != batcher.nInputs() || n_values > protocol::MAX_REQUEST_VALUES)
+                {
+                    protocol::ResponseHeader response{ protocol::Status::bad_request, 0 };
+                    connection.writeAll(&response, sizeof(response));
+                    return;
+                }
+
+                x.resize(n_values);
+                out.resize(request.n_rows * batcher.nOutputs());
+                if (!connection.readAll(x.data(), x.size() * sizeof(double)) && !x.empty())
+                    return;
+                batcher.score(x, out);
+
+                protocol::ResponseHeader response{ protocol::Status::ok, static_cast<std::uint32_t>(out.size()) };
+                connection.writeAll(&response, sizeof(response));
+                connection.writeAll(out.data(), out.size() * sizeof(double));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Dropped connection: " << e.what() << '\n';
+        }
+    }
+
+    //Reports the achieved batching every few seconds while requests come in
+    void reportBatching(const MicroBatcher& batcher)
+    {
+        size_t last_rows{ 0 };
+        size_t last_batches{ 0 };
+        while (true)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds{ 10 });
+            size_t n_rows{ batcher.nRows() };
+            size_t n_batches{ batcher.nBatches() };
+            if (n_batches != last_batches)
+            {
+                std::cout << n_rows - last_rows << " rows in " << n_batches - last_batches << " batches, "
+                    << static_cast<double>(n_rows - last_rows) / static_cast<double>(n_batches - last_batches) << " rows per batch" << std::endl;
+            }
+            last_rows = n_rows;
+            last_batches = n_batches;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: inference_server <model file> <socket path> [max batch rows = 256] [max wait in microseconds = 200] [workers = hardware threads]\n";
+        return 1;
+    }
+
+#if defined(SIGPIPE)
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    try
+    {
+        size_t max_batch{ argc > 3 ? std::stoul(argv[3]) : 256 };
+        std::chrono::microseconds max_wait{ argc > 4 ? std::stol(argv[4]) : 200 };
+        size_t n_workers{ argc > 5 ? std::stoul(argv[5]) : std::max<size_t>(std::thread::hardware_concurrency(), 1) };
+
+        NeuralNet net{ std::string{ argv[1] } };
+        MicroBatcher batcher{ net, max_batch, max_wait, n_workers };
+        ipc::UnixSocket listener{ ipc::UnixSocket::listen(argv[2]) };
+        std::thread{ reportBatching, std::cref(batcher) }.detach();
+        std::cout << "Serving " << argv[1] << " on " << argv[2] << " with " << n_workers << " workers, batches of up to " << max_batch
+            << " rows, waiting up to " << max_wait.count() << " us" << std::endl;
+
+        //Runs until the process is stopped; a failed accept only loses that connection
+        while (true)
+        {
+            try
+            {
+                std::thread{ serveConnection, listener.accept(), std::ref(batcher) }.detach();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
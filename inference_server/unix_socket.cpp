@@ -0,0 +1,187 @@
+#include "unix_socket.h"
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    const ipc::UnixSocket::Handle INVALID_HANDLE{ INVALID_SOCKET };
+
+    //Winsock has to be started once per process before the first socket call
+    void startNetworking()
+    {
+        static const bool started{ [] {
+            WSADATA data{};
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+                throw std::runtime_error("Couldn't start Winsock!");
+            return true;
+        }() };
+        (void)started;
+    }
+
+    void closeHandle(const ipc::UnixSocket::Handle handle)
+    {
+        closesocket(static_cast<SOCKET>(handle));
+    }
+#else
+    const ipc::UnixSocket::Handle INVALID_HANDLE{ -1 };
+
+    void startNetworking()
+    {
+    }
+
+    void closeHandle(const ipc::UnixSocket::Handle handle)
+    {
+        ::close(handle);
+    }
+#endif
+
+    sockaddr_un socketAddress(const std::string& path)
+    {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("Socket path is too long!");
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    ipc::UnixSocket::Handle openSocket()
+    {
+        startNetworking();
+        ipc::UnixSocket::Handle handle{ static_cast<ipc::UnixSocket::Handle>(::socket(AF_UNIX, SOCK_STREAM, 0)) };
+        if (handle == INVALID_HANDLE)
+            throw std::runtime_error("Couldn't create socket!");
+        return handle;
+    }
+}
+
+namespace ipc
+{
+    UnixSocket::UnixSocket(const Handle handle)
+        : m_handle{ handle }
+    {
+    }
+
+    UnixSocket::UnixSocket()
+        : m_handle{ INVALID_HANDLE }
+    {
+    }
+
+    UnixSocket::UnixSocket(UnixSocket&& other) noexcept
+        : m_handle{ std::exchange(other.m_handle, INVALID_HANDLE) }
+    {
+    }
+
+    UnixSocket& UnixSocket::operator=(UnixSocket&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            m_handle = std::exchange(other.m_handle, INVALID_HANDLE);
+        }
+        return *this;
+    }
+
+    UnixSocket::~UnixSocket()
+    {
+        close();
+    }
+
+    UnixSocket UnixSocket::listen(const std::string& path)
+    {
+        std::error_code ignored{};
+        std::filesystem::remove(path, ignored);
+
+        UnixSocket listener{ openSocket() };
+        sockaddr_un address{ socketAddress(path) };
+        if (::bind(listener.m_handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            throw std::runtime_error("Couldn't bind socket to " + path + "!");
+        if (::listen(listener.m_handle, SOMAXCONN) != 0)
+            throw std::runtime_error("Couldn't listen on " + path + "!");
+        return listener;
+    }
+
+    UnixSocket UnixSocket::connect(const std::string& path)
+    {
+        UnixSocket connection{ openSocket() };
+        sockaddr_un address{ socketAddress(path) };
+        if (::connect(connection.m_handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            throw std::runtime_error("Couldn't connect to " + path + "!");
+        return connection;
+    }
+
+    UnixSocket UnixSocket::accept() const
+    {
+        Handle handle{ static_cast<Handle>(::accept(m_handle, nullptr, nullptr)) };
+        if (handle == INVALID_HANDLE)
+            throw std::runtime_error("Couldn't accept connection!");
+        return UnixSocket{ handle };
+    }
+
+    bool UnixSocket::readAll(void* data, const size_t n) const
+    {
+        char* bytes{ static_cast<char*>(data) };
+        size_t n_read{ 0 };
+        while (n_read < n)
+        {
+            auto received{ ::recv(m_handle, bytes + n_read, static_cast<int>(n - n_read), 0) };
+            if (received == 0 && n_read == 0)
+                return false;
+            if (received <= 0)
+            {
+#if !defined(_WIN32)
+                if (received < 0 && errno == EINTR)
+                    continue;
+#endif
+                throw std::runtime_error("Connection closed in the middle of a message!");
+            }
+            n_read += static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    void UnixSocket::writeAll(const void* data, const size_t n) const
+    {
+        //A peer that went away must surface as an error here, not as SIGPIPE
+#if defined(MSG_NOSIGNAL)
+        const int flags{ MSG_NOSIGNAL };
+#else
+        const int flags{ 0 };
+#endif
+        const char* bytes{ static_cast<const char*>(data) };
+        size_t n_written{ 0 };
+        while (n_written < n)
+        {
+            auto sent{ ::send(m_handle, bytes + n_written, static_cast<int>(n - n_written), flags) };
+            if (sent <= 0)
+            {
+#if !defined(_WIN32)
+                if (sent < 0 && errno == EINTR)
+                    continue;
+#endif
+                throw std::runtime_error("Couldn't write to connection!");
+            }
+            n_written += static_cast<size_t>(sent);
+        }
+    }
+
+    void UnixSocket::close()
+    {
+        if (m_handle != INVALID_HANDLE)
+            closeHandle(std::exchange(m_handle, INVALID_HANDLE));
+    }
+}
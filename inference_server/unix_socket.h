@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ipc
+{
+    //Stream socket bound to a filesystem path (AF_UNIX), available on Linux, macOS and Windows 10 1803 or later.
+    //Owns its handle and closes it on destruction; failures throw std::runtime_error.
+    class UnixSocket
+    {
+    public:
+#if defined(_WIN32)
+        using Handle = std::uintptr_t;
+#else
+        using Handle = int;
+#endif
+
+    private:
+        Handle m_handle;
+
+        explicit UnixSocket(const Handle handle);
+
+    public:
+        UnixSocket();
+        UnixSocket(UnixSocket&& other) noexcept;
+        UnixSocket& operator=(UnixSocket&& other) noexcept;
+        UnixSocket(const UnixSocket&) = delete;
+        UnixSocket& operator=(const UnixSocket&) = delete;
+        ~UnixSocket();
+
+        //Removes a stale socket file left at path by an earlier run before binding
+        static UnixSocket listen(const std::string& path);
+        static UnixSocket connect(const std::string& path);
+        UnixSocket accept() const;
+
+        //Returns false if the peer closed the connection before sending anything, and throws if it closed midway
+        bool readAll(void* data, const size_t n) const;
+        void writeAll(const void* data, const size_t n) const;
+        void close();
+    };
+}
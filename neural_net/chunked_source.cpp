@@ -0,0 +1,108 @@
+#include "chunked_source.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T>
+BasicChunkedSource<T> BasicChunkedSource<T>::fromCsv(const std::string& filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols,
+    const size_t chunk_bytes)
+{
+    BasicChunkedSource source{};
+    source.m_csv.emplace(filename, label_cols, feature_cols, chunk_bytes);
+    return source;
+}
+
+template <typename T>
+BasicChunkedSource<T> BasicChunkedSource<T>::fromDataset(const std::string& filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols,
+    const size_t chunk_bytes)
+{
+    BasicChunkedSource source{};
+    const BasicDataset<T>& dataset{ source.m_dataset.emplace(filename) };
+
+    std::vector<bool> selected(dataset.nCol());
+    auto resolve{ [&](const std::vector<CsvColumn>& selection, std::vector<size_t>& cols) {
+        for (const CsvColumn& column : selection)
+        {
+            size_t col{ column.resolve(dataset.colnames()) };
+            if (selected[col])
+                throw std::invalid_argument("Column " + dataset.colnames()[col] + " is selected more than once!");
+            selected[col] = true;
+            cols.push_back(col);
+        }
+    } };
+    resolve(label_cols, source.m_label_cols);
+    resolve(feature_cols, source.m_feature_cols);
+
+    size_t row_bytes{ std::max<size_t>(dataset.nCol(), 1) * sizeof(T) };
+    source.m_chunk_rows = std::max<size_t>(chunk_bytes / row_bytes, 1);
+    return source;
+}
+
+template <typename T>
+size_t BasicChunkedSource<T>::nChunks() const
+{
+    if (m_csv)
+        return m_csv->nChunks();
+    return (m_dataset->nRow() + m_chunk_rows - 1) / m_chunk_rows;
+}
+
+template <typename T>
+size_t BasicChunkedSource<T>::nRows() const
+{
+    return m_csv ? m_csv->nRows() : m_dataset->nRow();
+}
+
+template <typename T>
+size_t BasicChunkedSource<T>::nLabels() const
+{
+    return m_csv ? m_csv->nLabels() : m_label_cols.size();
+}
+
+template <typename T>
+size_t BasicChunkedSource<T>::nFeatures() const
+{
+    return m_csv ? m_csv->nFeatures() : m_feature_cols.size();
+}
+
+template <typename T>
+void BasicChunkedSource<T>::readChunk(const size_t chunk, BasicMatrix<T>& y, BasicMatrix<T>& x) const
+{
+    if (m_csv)
+    {
+        //The CSV parser reads doubles
+        if constexpr (std::is_same_v<T, double>)
+        {
+            m_csv->readChunk(chunk, y, x);
+        }
+        else
+        {
+            Matrix y_chunk{};
+            Matrix x_chunk{};
+            m_csv->readChunk(chunk, y_chunk, x_chunk);
+            y = BasicMatrix<T>{ y_chunk };
+            x = BasicMatrix<T>{ x_chunk };
+        }
+        return;
+    }
+
+    if (chunk >= nChunks())
+        throw std::invalid_argument("Index exceeds dimensions!");
+    size_t first_row{ chunk * m_chunk_rows };
+    size_t n_rows{ std::min(m_chunk_rows, m_dataset->nRow() - first_row) };
+    BasicMatrixView<T> rows{ m_dataset->view().rows(first_row, n_rows) };
+    auto copyColumns{ [&](const std::vector<size_t>& cols, BasicMatrix<T>& output) {
+        output.resize(n_rows, cols.size());
+        for (size_t row{ 0 }; row < n_rows; row++)
+        {
+            for (size_t j{ 0 }; j < cols.size(); j++)
+            {
+                output(row, j) = rows(row, cols[j]);
+            }
+        }
+    } };
+    copyColumns(m_label_cols, y);
+    copyColumns(m_feature_cols, x);
+}
+
+template class BasicChunkedSource<float>;
+template class BasicChunkedSource<double>;
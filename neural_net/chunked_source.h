@@ -0,0 +1,43 @@
+#pragma once
+#include "dataset.h"
+#include "matrix.h"
+#include "read_csv.h"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+//Training rows handed out a chunk at a time from a CSV or dataset file, for training on files larger than memory.
+//Either kind of file stays memory-mapped and is split into chunks of about chunk_bytes of the file, so only the
+//chunk being read is copied into process memory. Label and feature columns are picked as in read_csv.
+template <typename T>
+class BasicChunkedSource
+{
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES{ size_t{ 64 } << 20 };
+
+private:
+    std::optional<CsvChunkReader> m_csv{};
+    std::optional<BasicDataset<T>> m_dataset{};
+    std::vector<size_t> m_label_cols{};
+    std::vector<size_t> m_feature_cols{};
+    size_t m_chunk_rows{};
+
+    BasicChunkedSource() = default;
+
+public:
+    static BasicChunkedSource fromCsv(const std::string& filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols,
+        const size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+    static BasicChunkedSource fromDataset(const std::string& filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols,
+        const size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+
+    size_t nChunks() const;
+    size_t nRows() const;
+    size_t nLabels() const;
+    size_t nFeatures() const;
+    //Replaces y and x with the label and feature rows of chunk
+    void readChunk(const size_t chunk, BasicMatrix<T>& y, BasicMatrix<T>& x) const;
+};
+
+using ChunkedSource = BasicChunkedSource<double>;
+using FloatChunkedSource = BasicChunkedSource<float>;
@@ -0,0 +1,227 @@
+#include "dataset.h"
+#include "matrix.h"
+#include "read_csv.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+    constexpr char MAGIC[8]{ 'N', 'N', 'D', 'A', 'T', 'A', '\r', '\n' };
+    constexpr std::uint32_t BYTE_ORDER_MARK{ 0x01020304 };
+    constexpr std::uint32_t FORMAT_VERSION{ 1 };
+
+    enum class ElementType : std::uint32_t
+    {
+        float32 = 1,
+        float64 = 2
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t byte_order;
+        std::uint32_t version;
+        ElementType element_type;
+        std::uint32_t reserved;
+        std::uint64_t n_rows;
+        std::uint64_t n_cols;
+        std::uint64_t data_offset;
+        std::uint64_t names_size;
+    };
+
+    template <typename T>
+    constexpr ElementType elementType()
+    {
+        return std::is_same_v<T, float> ? ElementType::float32 : ElementType::float64;
+    }
+
+    const char* elementName(const ElementType element_type)
+    {
+        switch (element_type)
+        {
+        case ElementType::float32:
+            return "float";
+        case ElementType::float64:
+            return "double";
+        default:
+            return "an unknown type";
+        }
+    }
+}
+
+namespace dataset
+{
+    template <typename T>
+    void write(const std::string& filename, const std::vector<std::string>& colnames, const BasicMatrixView<T>& data)
+    {
+        if (colnames.size() != data.nCol())
+            throw std::invalid_argument("Need one name per column!");
+
+        std::string names{};
+        for (size_t col{ 0 }; col < colnames.size(); col++)
+        {
+            if (colnames[col].find('\n') != std::string::npos)
+                throw std::invalid_argument("Column names can't contain newlines!");
+            names += colnames[col];
+            if (col + 1 < colnames.size())
+                names += '\n';
+        }
+
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.byte_order = BYTE_ORDER_MARK;
+        header.version = FORMAT_VERSION;
+        header.element_type = elementType<T>();
+        header.n_rows = data.nRow();
+        header.n_cols = data.nCol();
+        header.names_size = names.size();
+        header.data_offset = (sizeof(header) + names.size() + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+
+        std::ofstream outfile(filename, std::ios::binary);
+        if (!outfile.good())
+            throw std::invalid_argument("Couldn't open file!");
+
+        outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        outfile.write(names.data(), static_cast<std::streamsize>(names.size()));
+        const char padding[DATA_ALIGNMENT]{};
+        outfile.write(padding, static_cast<std::streamsize>(header.data_offset - sizeof(header) - names.size()));
+
+        if (data.isContiguous())
+        {
+            outfile.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(T)));
+        }
+        else
+        {
+            std::vector<T> row(data.nCol());
+            for (size_t i{ 0 }; i < data.nRow(); i++)
+            {
+                for (size_t j{ 0 }; j < data.nCol(); j++)
+                {
+                    row[j] = data(i, j);
+                }
+                outfile.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(T)));
+            }
+        }
+
+        if (!outfile.good())
+            throw std::runtime_error("Couldn't write dataset " + filename + "!");
+    }
+
+    template <typename T>
+    void convertCsv(const std::string& csv_filename, const std::string& dataset_filename)
+    {
+        data_frame frame{ read_csv(csv_filename) };
+        if constexpr (std::is_same_v<T, double>)
+            write<T>(dataset_filename, frame.first, frame.second);
+        else
+            write<T>(dataset_filename, frame.first, BasicMatrix<T>{ frame.second });
+    }
+
+    template void write(const std::string& filename, const std::vector<std::string>& colnames, const BasicMatrixView<float>& data);
+    template void write(const std::string& filename, const std::vector<std::string>& colnames, const BasicMatrixView<double>& data);
+    template void convertCsv<float>(const std::string& csv_filename, const std::string& dataset_filename);
+    template void convertCsv<double>(const std::string& csv_filename, const std::string& dataset_filename);
+}
+
+template <typename T>
+BasicDataset<T>::BasicDataset(const std::string& filename)
+    : m_file{ filename }
+{
+    FileHeader header{};
+    if (m_file.size() < sizeof(header))
+        throw std::runtime_error(filename + " is too short to be a dataset!");
+    std::memcpy(&header, m_file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw std::runtime_error(filename + " is not a dataset file!");
+    if (header.byte_order != BYTE_ORDER_MARK)
+        throw std::runtime_error(filename + " was written with the other byte order!");
+    if (header.version != FORMAT_VERSION)
+        throw std::runtime_error(filename + " has an unsupported format version!");
+    if (header.element_type != elementType<T>())
+        throw std::runtime_error(filename + " holds " + elementName(header.element_type) + " elements, not " + elementName(elementType<T>()) + "!");
+
+    //Checked so that a corrupt header can't make the size computation wrap around
+    size_t max_elements{ std::numeric_limits<size_t>::max() / sizeof(T) };
+    if (header.n_cols != 0 && header.n_rows > max_elements / header.n_cols)
+        throw std::runtime_error(filename + " has an impossible size!");
+    size_t data_size{ static_cast<size_t>(header.n_rows * header.n_cols) * sizeof(T) };
+    if (header.data_offset % dataset::DATA_ALIGNMENT != 0 || header.data_offset < sizeof(header) || header.names_size > header.data_offset - sizeof(header)
+        || header.data_offset > m_file.size() || m_file.size() - header.data_offset < data_size)
+        throw std::runtime_error(filename + " is truncated or corrupt!");
+
+    const char* names{ m_file.data() + sizeof(header) };
+    const char* names_end{ names + header.names_size };
+    if (header.n_cols > 0)
+    {
+        for (const char* name{ names };;)
+        {
+            const char* name_end{ std::find(name, names_end, '\n') };
+            m_colnames.emplace_back(name, name_end);
+            if (name_end == names_end)
+                break;
+            name = name_end + 1;
+        }
+    }
+    if (m_colnames.size() != header.n_cols)
+        throw std::runtime_error(filename + " does not name every column!");
+
+    m_nrow = static_cast<size_t>(header.n_rows);
+    m_ncol = static_cast<size_t>(header.n_cols);
+    m_data = reinterpret_cast<const T*>(m_file.data() + header.data_offset);
+}
+
+template <typename T>
+size_t BasicDataset<T>::nRow() const
+{
+    return m_nrow;
+}
+
+template <typename T>
+size_t BasicDataset<T>::nCol() const
+{
+    return m_ncol;
+}
+
+template <typename T>
+const std::vector<std::string>& BasicDataset<T>::colnames() const
+{
+    return m_colnames;
+}
+
+template <typename T>
+size_t BasicDataset<T>::colIndex(const std::string& name) const
+{
+    auto it{ std::find(m_colnames.begin(), m_colnames.end(), name) };
+    if (it == m_colnames.end())
+        throw std::invalid_argument("No column named " + name + "!");
+    return static_cast<size_t>(it - m_colnames.begin());
+}
+
+template <typename T>
+const T* BasicDataset<T>::data() const
+{
+    return m_data;
+}
+
+template <typename T>
+BasicMatrixView<T> BasicDataset<T>::view() const
+{
+    return BasicMatrixView<T>{ m_data, m_nrow, m_ncol, m_ncol };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicDataset<T>::cols(const size_t first_col, const size_t count) const
+{
+    if (count == 0 || first_col + count > m_ncol)
+        throw std::invalid_argument("Index exceeds dimensions!");
+    return BasicMatrixView<T>{ m_data + first_col, m_nrow, count, m_ncol };
+}
+
+template class BasicDataset<float>;
+template class BasicDataset<double>;
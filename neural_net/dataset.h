@@ -0,0 +1,52 @@
+#pragma once
+#include "mapped_file.h"
+#include "matrix_view.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//Binary dataset files, written once from a CSV and then opened without parsing.
+//Layout, in native byte order: a fixed header (magic, byte-order mark, version, element type, rows, columns, data
+//offset and size of the names block), the column names separated by newlines, zero padding, and the row-major
+//elements starting at a multiple of DATA_ALIGNMENT bytes.
+namespace dataset
+{
+    inline constexpr size_t DATA_ALIGNMENT{ 64 };
+
+    //Writes data with one name per column; T is the element type stored in the file
+    template <typename T>
+    void write(const std::string& filename, const std::vector<std::string>& colnames, const BasicMatrixView<T>& data);
+    //Reads a CSV file with read_csv and writes it as a dataset of T
+    template <typename T>
+    void convertCsv(const std::string& csv_filename, const std::string& dataset_filename);
+}
+
+//A dataset file mapped into memory; views onto it read the file's pages directly, with nothing copied on load.
+//The header is validated on open and a file holding another element type is rejected with std::runtime_error.
+//Views must not outlive the dataset.
+template <typename T>
+class BasicDataset
+{
+private:
+    MappedFile m_file;
+    std::vector<std::string> m_colnames{};
+    size_t m_nrow{};
+    size_t m_ncol{};
+    const T* m_data{};
+
+public:
+    explicit BasicDataset(const std::string& filename);
+
+    size_t nRow() const;
+    size_t nCol() const;
+    const std::vector<std::string>& colnames() const;
+    //Position of the column with this name; throws std::invalid_argument if there is none
+    size_t colIndex(const std::string& name) const;
+    const T* data() const;
+    BasicMatrixView<T> view() const;
+    //count adjacent columns starting at first_col, e.g. the label or the feature block
+    BasicMatrixView<T> cols(const size_t first_col, const size_t count) const;
+};
+
+using Dataset = BasicDataset<double>;
+using FloatDataset = BasicDataset<float>;
@@ -0,0 +1,197 @@
+#include "frozen_net.h"
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    //First line of a frozen model file, which tells it apart from a trainable network's file
+    const std::string FROZEN_MODEL_TAG{ "frozen" };
+}
+
+template <typename T>
+BasicFrozenNet<T>::BasicFrozenNet(const BasicNeuralNet<T>& net)
+    : m_layers{ net.layers() }, m_activations{ net.activations() }
+{
+    const std::pair<std::vector<T>, std::vector<T>>& norm{ net.normalization() };
+    if (norm.first.size() != m_layers[0] || norm.second.size() != m_layers[0])
+        throw std::invalid_argument("Network has not been trained!");
+
+    layOut();
+
+    for (size_t i{ 0 }; i < m_offsets.size(); i++)
+    {
+        const BasicMatrix<T>& layer_weights{ net.weights()[i] };
+        const BasicMatrix<T>& layer_biases{ net.biases()[i] };
+        T* frozen_weights{ m_parameters.data() + m_offsets[i] };
+        T* frozen_biases{ frozen_weights + layer_weights.size() };
+        size_t n_out{ layer_weights.nRow() };
+
+        for (size_t row{ 0 }; row < n_out; row++)
+        {
+            //W ((x - mean) / std_dev) + b = (W / std_dev) x + (b - W (mean / std_dev)) for the first layer
+            double shift{ 0.0 };
+            for (size_t col{ 0 }; col < layer_weights.nCol(); col++)
+            {
+                double weight{ static_cast<double>(layer_weights(row, col)) };
+                if (i == 0)
+                {
+                    weight /= static_cast<double>(norm.second[col]);
+                    shift += weight * static_cast<double>(norm.first[col]);
+                }
+                frozen_weights[col * n_out + row] = static_cast<T>(weight);
+            }
+            frozen_biases[row] = static_cast<T>(static_cast<double>(layer_biases[row]) - shift);
+        }
+    }
+}
+
+template <typename T>
+BasicFrozenNet<T>::BasicFrozenNet(const std::string filename)
+{
+    this->load(filename);
+}
+
+template <typename T>
+void BasicFrozenNet<T>::layOut()
+{
+    if (m_layers.size() < 2 || m_activations.size() != m_layers.size() - 1)
+        throw std::invalid_argument("Need one activation function per layer after the input!");
+
+    m_offsets.clear();
+    size_t n_parameters{ 0 };
+    for (size_t i{ 1 }; i < m_layers.size(); i++)
+    {
+        m_offsets.push_back(n_parameters);
+        n_parameters += (m_layers[i - 1] + 1) * m_layers[i];
+    }
+    m_parameters.assign(n_parameters, T{ 0 });
+}
+
+template <typename T>
+void BasicFrozenNet<T>::save(const std::string filename) const
+{
+    std::ofstream outfile(filename);
+    outfile << std::setprecision(std::numeric_limits<T>::max_digits10);
+
+    outfile << FROZEN_MODEL_TAG << '\n';
+
+    for (ActivationFunction activation : m_activations)
+    {
+        outfile << static_cast<size_t>(activation) << ',';
+    }
+    outfile << '\n';
+
+    for (size_t layer : m_layers)
+    {
+        outfile << layer << ',';
+    }
+    outfile << '\n';
+
+    //Parameters go out in storage order, so loading is a single sequential read
+    for (T parameter : m_parameters)
+    {
+        outfile << parameter << ',';
+    }
+    outfile << '\n';
+}
+
+template <typename T>
+void BasicFrozenNet<T>::load(const std::string filename)
+{
+    m_layers.clear();
+    m_activations.clear();
+
+    std::ifstream infile(filename);
+
+    if (!infile.good())
+        throw std::invalid_argument("Couldn't open file!");
+
+    std::string line{ "" };
+    std::getline(infile, line);
+    if (line != FROZEN_MODEL_TAG)
+        throw std::invalid_argument("File does not hold a frozen model!");
+
+    size_t data_size_t{ 0 };
+    std::getline(infile, line);
+    std::istringstream iss_act{ line };
+    while (iss_act >> data_size_t)
+    {
+        if (iss_act.peek() == ',')
+            iss_act.ignore();
+
+        m_activations.push_back(static_cast<ActivationFunction>(data_size_t));
+    }
+
+    std::getline(infile, line);
+    std::istringstream iss_layers{ line };
+    while (iss_layers >> data_size_t)
+    {
+        if (iss_layers.peek() == ',')
+            iss_layers.ignore();
+
+        m_layers.push_back(data_size_t);
+    }
+
+    layOut();
+    for (ActivationFunction activation : m_activations)
+    {
+        //Rejects activation codes this build doesn't know
+        activation_functions::kernelsFor<T>(activation);
+    }
+
+    //Parsed as double and converted, so a model frozen in either precision loads into either
+    double data{ 0.0 };
+    std::getline(infile, line);
+    std::istringstream iss_parameters{ line };
+    for (T& parameter : m_parameters)
+    {
+        if (!(iss_parameters >> data))
+            throw std::invalid_argument("Frozen model file is missing parameters!");
+        if (iss_parameters.peek() == ',')
+            iss_parameters.ignore();
+
+        parameter = static_cast<T>(data);
+    }
+}
+
+template <typename T>
+const std::vector<size_t>& BasicFrozenNet<T>::layers() const
+{
+    return m_layers;
+}
+
+template <typename T>
+const std::vector<ActivationFunction>& BasicFrozenNet<T>::activations() const
+{
+    return m_activations;
+}
+
+template <typename T>
+size_t BasicFrozenNet<T>::nInputs() const
+{
+    return m_layers.front();
+}
+
+template <typename T>
+size_t BasicFrozenNet<T>::nOutputs() const
+{
+    return m_layers.back();
+}
+
+template <typename T>
+BasicMatrixView<T> BasicFrozenNet<T>::weights(const size_t layer) const
+{
+    return BasicMatrixView<T>{ m_parameters.data() + m_offsets[layer], m_layers[layer], m_layers[layer + 1], m_layers[layer + 1] };
+}
+
+template <typename T>
+const T* BasicFrozenNet<T>::biases(const size_t layer) const
+{
+    return m_parameters.data() + m_offsets[layer] + m_layers[layer] * m_layers[layer + 1];
+}
+
+template class BasicFrozenNet<float>;
+template class BasicFrozenNet<double>;
@@ -0,0 +1,39 @@
+#pragma once
+#include "neural_network.h"
+#include <string>
+#include <vector>
+
+//A trained network reduced to what scoring needs, saved and loaded as its own model kind.
+//Freezing folds the input normalization into the first layer, drops the training state, and stores every layer's
+//parameters in one contiguous block in the order the inference kernels read them: the layer's weights transposed to
+//n_in x n_out, so a row-major batch multiplies them directly, followed by its biases.
+template <typename T>
+class BasicFrozenNet
+{
+private:
+    std::vector<size_t> m_layers{};
+    std::vector<ActivationFunction> m_activations{};
+    std::vector<T> m_parameters{};
+    //Start of each layer's weights in m_parameters
+    std::vector<size_t> m_offsets{};
+
+    void layOut();
+
+public:
+    explicit BasicFrozenNet(const BasicNeuralNet<T>& net);
+    BasicFrozenNet(const std::string filename);
+
+    void save(const std::string filename) const;
+    void load(const std::string filename);
+
+    const std::vector<size_t>& layers() const;
+    const std::vector<ActivationFunction>& activations() const;
+    size_t nInputs() const;
+    size_t nOutputs() const;
+    //Layer i's n_in x n_out weights and its n_out biases
+    BasicMatrixView<T> weights(const size_t layer) const;
+    const T* biases(const size_t layer) const;
+};
+
+using FrozenNet = BasicFrozenNet<double>;
+using FloatFrozenNet = BasicFrozenNet<float>;
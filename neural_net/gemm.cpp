@@ -0,0 +1,268 @@
+#include "gemm.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    //Register tile computed by the micro-kernel; a row of the tile spans the same 64 bytes in either precision
+    constexpr size_t MR{ 4 };
+    template <typename T>
+    constexpr size_t NR{ 64 / sizeof(T) };
+    //Cache blocks: an MC x KC panel of A stays in L2, a KC x NR sliver of B stays in L1
+    constexpr size_t MC{ 96 };
+    constexpr size_t KC{ 256 };
+    constexpr size_t NC{ 4096 };
+    //Below this many multiply-adds packing costs more than it saves
+    constexpr size_t SMALL_PRODUCT{ 2048 };
+    //Multiply-adds each thread gets at least when a product is split, enough to amortize handing out the work
+    constexpr size_t TASK_PRODUCT{ 1 << 17 };
+
+    //Packs the mc x kc block of A starting at (ic, pc) into panels of MR rows, stored column by column and zero padded
+    template <typename T>
+    void packA(const BasicMatrixView<T>& a, const size_t ic, const size_t pc, const size_t mc, const size_t kc, T* buffer)
+    {
+        const T* data{ a.data() };
+        for (size_t i{ 0 }; i < mc; i += MR)
+        {
+            size_t mr{ std::min(MR, mc - i) };
+            size_t row_offset[MR]{};
+            for (size_t ii{ 0 }; ii < mr; ii++)
+            {
+                row_offset[ii] = a.rowOffset(ic + i + ii);
+            }
+            for (size_t p{ 0 }; p < kc; p++)
+            {
+                size_t col_offset{ a.colOffset(pc + p) };
+                for (size_t ii{ 0 }; ii < mr; ii++)
+                {
+                    *buffer++ = data[row_offset[ii] + col_offset];
+                }
+                for (size_t ii{ mr }; ii < MR; ii++)
+                {
+                    *buffer++ = T{ 0 };
+                }
+            }
+        }
+    }
+
+    //Packs the kc x nc block of B starting at (pc, jc) into panels of NR columns, stored row by row and zero padded
+    template <typename T>
+    void packB(const BasicMatrixView<T>& b, const size_t pc, const size_t jc, const size_t kc, const size_t nc, T* buffer)
+    {
+        const T* data{ b.data() };
+        for (size_t j{ 0 }; j < nc; j += NR<T>)
+        {
+            size_t nr{ std::min(NR<T>, nc - j) };
+            size_t col_offset[NR<T>]{};
+            for (size_t jj{ 0 }; jj < nr; jj++)
+            {
+                col_offset[jj] = b.colOffset(jc + j + jj);
+            }
+            for (size_t p{ 0 }; p < kc; p++)
+            {
+                const T* b_row{ data + b.rowOffset(pc + p) };
+                for (size_t jj{ 0 }; jj < nr; jj++)
+                {
+                    *buffer++ = b_row[col_offset[jj]];
+                }
+                for (size_t jj{ nr }; jj < NR<T>; jj++)
+                {
+                    *buffer++ = T{ 0 };
+                }
+            }
+        }
+    }
+
+    //Accumulates the ROWS x NR product of a packed A panel and a B sliver into C, writing back only the valid nr columns.
+    //B rows are b_rs apart so the kernel can read either a packed panel or row-major B in place.
+    template <size_t ROWS, typename T>
+    void microKernel(const size_t kc, const T* a, const T* b, const size_t b_rs, T* c, const size_t c_rs, const size_t nr)
+    {
+        T acc[ROWS][NR<T>]{};
+
+        for (size_t p{ 0 }; p < kc; p++)
+        {
+            for (size_t i{ 0 }; i < ROWS; i++)
+            {
+                T a_ip{ a[i] };
+                for (size_t j{ 0 }; j < NR<T>; j++)
+                {
+                    acc[i][j] += a_ip * b[j];
+                }
+            }
+            a += MR;
+            b += b_rs;
+        }
+
+        for (size_t i{ 0 }; i < ROWS; i++)
+        {
+            for (size_t j{ 0 }; j < nr; j++)
+            {
+                c[i * c_rs + j] += acc[i][j];
+            }
+        }
+    }
+
+    //Selects the micro-kernel instance for the number of valid rows, so short edge panels do no padded work
+    template <typename T>
+    void microKernel(const size_t kc, const T* a, const T* b, const size_t b_rs, T* c, const size_t c_rs, const size_t mr, const size_t nr)
+    {
+        switch (mr)
+        {
+        case 1:
+            microKernel<1>(kc, a, b, b_rs, c, c_rs, nr);
+            break;
+        case 2:
+            microKernel<2>(kc, a, b, b_rs, c, c_rs, nr);
+            break;
+        case 3:
+            microKernel<3>(kc, a, b, b_rs, c, c_rs, nr);
+            break;
+        default:
+            microKernel<MR>(kc, a, b, b_rs, c, c_rs, nr);
+            break;
+        }
+    }
+
+    //Row-oriented i-p-j loop for products too small to amortize packing
+    template <typename T>
+    void multiplySmall(const BasicMatrixView<T>& a, const BasicMatrixView<T>& b, T* c, const size_t c_rs)
+    {
+        for (size_t i{ 0 }; i < a.nRow(); i++)
+        {
+            T* c_row{ c + i * c_rs };
+            for (size_t p{ 0 }; p < a.nCol(); p++)
+            {
+                T a_ip{ a(i, p) };
+                const T* b_row{ b.data() + b.rowOffset(p) };
+                for (size_t j{ 0 }; j < b.nCol(); j++)
+                {
+                    c_row[j] += a_ip * b_row[b.colOffset(j)];
+                }
+            }
+        }
+    }
+
+    //Blocked product of packed panels; C must be zeroed
+    template <typename T>
+    void multiplyPacked(const BasicMatrixView<T>& a, const BasicMatrixView<T>& b, T* c, const size_t c_rs)
+    {
+        size_t m{ a.nRow() };
+        size_t n{ b.nCol() };
+        size_t k{ a.nCol() };
+
+        //Packing buffers are reused across calls so steady-state multiplies do not allocate
+        thread_local std::vector<T> a_packed{};
+        thread_local std::vector<T> b_packed{};
+
+        //B is only worth packing when several A panels reuse it or when its rows are not contiguous
+        bool pack_b{ m > MR || b.hasIndirection() || b.colStride() != 1 };
+
+        size_t a_capacity{ ((std::min(MC, m) + MR - 1) / MR) * MR * std::min(KC, k) };
+        size_t b_capacity{ (pack_b ? ((std::min(NC, n) + NR<T> - 1) / NR<T>) * NR<T> : NR<T>) * std::min(KC, k) };
+        if (a_packed.size() < a_capacity)
+            a_packed.resize(a_capacity);
+        if (b_packed.size() < b_capacity)
+            b_packed.resize(b_capacity);
+
+        for (size_t jc{ 0 }; jc < n; jc += NC)
+        {
+            size_t nc{ std::min(NC, n - jc) };
+
+            for (size_t pc{ 0 }; pc < k; pc += KC)
+            {
+                size_t kc{ std::min(KC, k - pc) };
+                const T* b_block{ b.data() + pc * b.rowStride() + jc };
+                if (pack_b)
+                    packB(b, pc, jc, kc, nc, b_packed.data());
+
+                for (size_t ic{ 0 }; ic < m; ic += MC)
+                {
+                    size_t mc{ std::min(MC, m - ic) };
+                    packA(a, ic, pc, mc, kc, a_packed.data());
+
+                    for (size_t jr{ 0 }; jr < nc; jr += NR<T>)
+                    {
+                        size_t nr{ std::min(NR<T>, nc - jr) };
+                        const T* b_sliver{ b_packed.data() + jr * kc };
+                        size_t b_sliver_rs{ NR<T> };
+
+                        if (!pack_b && nr == NR<T>)
+                        {
+                            b_sliver = b_block + jr;
+                            b_sliver_rs = b.rowStride();
+                        }
+                        else if (!pack_b)
+                        {
+                            //The ragged last sliver is padded so the kernel never reads past the row
+                            packB(b, pc, jc + jr, kc, nr, b_packed.data());
+                            b_sliver = b_packed.data();
+                        }
+
+                        for (size_t ir{ 0 }; ir < mc; ir += MR)
+                        {
+                            microKernel(kc, a_packed.data() + ir * kc, b_sliver, b_sliver_rs,
+                                c + (ic + ir) * c_rs + jc + jr, c_rs, std::min(MR, mc - ir), nr);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace gemm
+{
+    template <typename T>
+    void multiply(const BasicMatrixView<T>& a, const BasicMatrixView<T>& b, T* c, const size_t c_rs)
+    {
+        if (a.nCol() != b.nRow())
+            throw std::invalid_argument("Matrices are not compatible for multiplication!");
+
+        size_t m{ a.nRow() };
+        size_t n{ b.nCol() };
+        size_t k{ a.nCol() };
+
+        for (size_t i{ 0 }; i < m; i++)
+        {
+            std::fill(c + i * c_rs, c + i * c_rs + n, T{ 0 });
+        }
+
+        if (m == 0 || n == 0 || k == 0)
+            return;
+
+        if (m * n * k <= SMALL_PRODUCT)
+        {
+            multiplySmall(a, b, c, c_rs);
+            return;
+        }
+
+        //Large products are split into blocks of whole micro-tiles along the longer side of C, one block per thread.
+        //Every block keeps the k blocking of the full product, so the result does not depend on the thread count.
+        if (m >= n)
+        {
+            size_t grain{ std::max<size_t>(TASK_PRODUCT / (MR * n * k), 1) };
+            parallel::forRange((m + MR - 1) / MR, grain, [&](const size_t first, const size_t last)
+                {
+                    size_t first_row{ first * MR };
+                    size_t n_rows{ std::min(last * MR, m) - first_row };
+                    multiplyPacked(a.rows(first_row, n_rows), b, c + first_row * c_rs, c_rs);
+                });
+        }
+        else
+        {
+            size_t grain{ std::max<size_t>(TASK_PRODUCT / (NR<T> * m * k), 1) };
+            parallel::forRange((n + NR<T> - 1) / NR<T>, grain, [&](const size_t first, const size_t last)
+                {
+                    size_t first_col{ first * NR<T> };
+                    size_t n_cols{ std::min(last * NR<T>, n) - first_col };
+                    multiplyPacked(a, b.transpose().rows(first_col, n_cols).transpose(), c + first_col, c_rs);
+                });
+        }
+    }
+
+    template void multiply(const BasicMatrixView<float>&, const BasicMatrixView<float>&, float*, const size_t);
+    template void multiply(const BasicMatrixView<double>&, const BasicMatrixView<double>&, double*, const size_t);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+#include "matrix_view.h"
+
+namespace gemm
+{
+    //Computes C = A * B where A is m x k, B is k x n and C is m x n.
+    //A and B may be any views: strided, transposed or gathered through an index.
+    //C is row-major with row stride c_rs and is overwritten.
+    //Instantiated for float and double.
+    template <typename T>
+    void multiply(const BasicMatrixView<T>& a, const BasicMatrixView<T>& b, T* c, const size_t c_rs);
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "header_export.h"
+#include "frozen_net.h"
+#include "simd_constants.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+    template <typename T>
+    std::string literal(const T value)
+    {
+        std::ostringstream oss{};
+        oss << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+        std::string text{ oss.str() };
+        if (text.find_first_of(".e") == std::string::npos)
+            text += ".0";
+        //Float constants carry the suffix so that no double-to-float truncation is left to the compiler
+        if constexpr (std::is_same_v<T, float>)
+            text += 'f';
+        return text;
+    }
+
+    //Writes values as a brace list, n_cols to a row
+    template <typename T>
+    void writeArray(std::ofstream& outfile, const T* values, const size_t n_rows, const size_t n_cols, const size_t row_stride)
+    {
+        outfile << "{\n";
+        for (size_t row{ 0 }; row < n_rows; row++)
+        {
+            outfile << "        " << (n_rows > 1 ? "{ " : "");
+            for (size_t col{ 0 }; col < n_cols; col++)
+            {
+                outfile << literal(values[row * row_stride + col]) << (col + 1 < n_cols ? ", " : "");
+            }
+            outfile << (n_rows > 1 ? " }" : "") << (row + 1 < n_rows ? ",\n" : "\n");
+        }
+        outfile << "    };\n";
+    }
+
+    //Brace list of a constant array, for the coefficient tables
+    template <typename T, size_t N>
+    void writeList(std::ofstream& outfile, const T (&values)[N])
+    {
+        outfile << "{ ";
+        for (size_t i{ 0 }; i < N; i++)
+        {
+            outfile << literal(values[i]) << (i + 1 < N ? ", " : "");
+        }
+        outfile << " };\n";
+    }
+
+    const char* activationName(const ActivationFunction activation)
+    {
+        switch (activation)
+        {
+        case ActivationFunction::identity:
+            return "identity";
+        case ActivationFunction::sigmoid:
+        case ActivationFunction::sigmoid_fast:
+            return "sigmoid";
+        case ActivationFunction::tanh:
+        case ActivationFunction::tanh_fast:
+            return "tanh";
+        case ActivationFunction::relu:
+            return "relu";
+        case ActivationFunction::softplus:
+        case ActivationFunction::softplus_fast:
+            return "softplus";
+        default:
+            throw std::invalid_argument("Unknown activation function!");
+        }
+    }
+
+    bool isIdentifier(const std::string& name)
+    {
+        return !name.empty() && !std::isdigit(static_cast<unsigned char>(name.front()))
+            && std::all_of(name.begin(), name.end(), [](const char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+    }
+}
+
+namespace header_export
+{
+    template <typename T>
+    void write(const BasicNeuralNet<T>& net, const BasicMatrix<T>& reference_x, const std::string& filename, const std::string& name_space)
+    {
+        if (!isIdentifier(name_space))
+            throw std::invalid_argument("Namespace must be a C++ identifier!");
+        if (reference_x.nRow() == 0 || reference_x.nCol() != net.layers().front())
+            throw std::invalid_argument("Reference rows do not match the network!");
+
+        BasicFrozenNet<T> model{ net };
+        BasicMatrix<T> reference_y{ net.predict(reference_x) };
+        const std::vector<size_t>& layers{ model.layers() };
+        const char* scalar{ std::is_same_v<T, float> ? "float" : "double" };
+
+        std::ofstream outfile(filename);
+        if (!outfile.good())
+            throw std::invalid_argument("Couldn't open file!");
+
+        outfile << "#pragma once\n"
+            << "//Generated by header_export::write from a trained network; regenerate instead of editing.\n"
+            << "#include <algorithm>\n#include <bit>\n#include <cmath>\n#include <cstddef>\n#include <cstdint>\n#include <limits>\n\n"
+            << "namespace " << name_space << "\n{\n"
+            << "    using Scalar = " << scalar << ";\n\n"
+            << "    inline constexpr std::size_t n_inputs{ " << layers.front() << " };\n"
+            << "    inline constexpr std::size_t n_outputs{ " << layers.back() << " };\n\n"
+            << "    //weights_i[k][j] takes input k of layer i to its output j; the input normalization is folded into layer 0\n";
+        for (size_t i{ 0 }; i + 1 < layers.size(); i++)
+        {
+            outfile << "    alignas(64) inline constexpr Scalar weights_" << i << "[" << layers[i] << "][" << layers[i + 1] << "]";
+            writeArray(outfile, model.weights(i).data(), layers[i], layers[i + 1], layers[i + 1]);
+            outfile << "    alignas(64) inline constexpr Scalar biases_" << i << "[" << layers[i + 1] << "]";
+            writeArray(outfile, model.biases(i), 1, layers[i + 1], layers[i + 1]);
+            outfile << '\n';
+        }
+
+        using C = simd::MathConstants<T>;
+        outfile << "    namespace detail\n    {\n"
+            << "        //The accurate approximations of the library's vector kernels, in scalar form without branches or libm calls\n"
+            << "        //so that the activation loops vectorize like the rest of the layer\n"
+            << "        using Bits = std::" << (std::is_same_v<T, float> ? "uint32_t" : "uint64_t") << ";\n"
+            << "        inline constexpr int mantissa_bits{ " << std::numeric_limits<T>::digits - 1 << " };\n"
+            << "        inline constexpr Scalar round_magic{ " << literal(C::round_magic) << " };\n"
+            << "        inline constexpr Scalar exp_max{ " << literal(C::exp_max) << " };\n"
+            << "        inline constexpr Scalar exp_min{ " << literal(C::exp_min) << " };\n"
+            << "        inline constexpr Scalar log2e{ " << literal(C::log2e) << " };\n"
+            << "        inline constexpr Scalar exp_ln2_hi{ " << literal(C::exp_ln2_hi) << " };\n"
+            << "        inline constexpr Scalar exp_ln2_lo{ " << literal(C::exp_ln2_lo) << " };\n"
+            << "        inline constexpr Scalar exp_coefficients[]";
+        writeList(outfile, C::exp_accurate);
+        outfile << "        inline constexpr Scalar tanh_small{ " << literal(C::tanh_small) << " };\n"
+            << "        inline constexpr Scalar tanh_p[]";
+        writeList(outfile, C::tanh_p);
+        outfile << "        inline constexpr Scalar tanh_q[]";
+        writeList(outfile, C::tanh_q);
+        outfile << "        inline constexpr Scalar sqrt2{ " << literal(C::sqrt2) << " };\n"
+            << "        inline constexpr Scalar log_ln2_hi{ " << literal(C::log_ln2_hi) << " };\n"
+            << "        inline constexpr Scalar log_ln2_lo{ " << literal(C::log_ln2_lo) << " };\n"
+            << "        inline constexpr Scalar log_coefficients[]";
+        writeList(outfile, C::log_accurate);
+        outfile << '\n'
+            << "        template <std::size_t N>\n"
+            << "        inline Scalar polynomial(const Scalar x, const Scalar (&coefficients)[N])\n"
+            << "        {\n"
+            << "            Scalar result{ coefficients[0] };\n"
+            << "            for (std::size_t i{ 1 }; i < N; i++)\n"
+            << "            {\n"
+            << "                result = result * x + coefficients[i];\n"
+            << "            }\n"
+            << "            return result;\n"
+            << "        }\n\n"
+            << "        //exp(x) = 2^n exp(r) with n = round(x / ln2) and |r| <= ln2 / 2\n"
+            << "        inline Scalar exp(const Scalar x)\n"
+            << "        {\n"
+            << "            Scalar clamped{ std::min(std::max(x, exp_min), exp_max) };\n"
+            << "            Scalar n_shifted{ clamped * log2e + round_magic };\n"
+            << "            Scalar n{ n_shifted - round_magic };\n"
+            << "            Scalar r{ clamped - n * exp_ln2_hi };\n"
+            << "            r = r - n * exp_ln2_lo;\n"
+            << "            Scalar result{ std::bit_cast<Scalar>(std::bit_cast<Bits>(polynomial(r, exp_coefficients)) + (std::bit_cast<Bits>(n_shifted) << mantissa_bits)) };\n"
+            << "            result = x > exp_max ? std::numeric_limits<Scalar>::infinity() : result;\n"
+            << "            return x < exp_min ? Scalar{ 0 } : result;\n"
+            << "        }\n\n"
+            << "        //log(1 + e) for e in [0, 1]: 1 + e = 2^k (1 + f) with 1 + f in [sqrt(2) / 2, sqrt(2)]\n"
+            << "        inline Scalar log1p(const Scalar e)\n"
+            << "        {\n"
+            << "            Scalar u{ Scalar{ 1 } + e };\n"
+            << "            bool halve{ u > sqrt2 };\n"
+            << "            Scalar k{ halve ? Scalar{ 1 } : Scalar{ 0 } };\n"
+            << "            Scalar f{ (halve ? u * Scalar{ 0.5 } : u) - Scalar{ 1 } };\n"
+            << "            Scalar s{ f / (Scalar{ 2 } + f) };\n"
+            << "            Scalar z{ s * s };\n"
+            << "            Scalar hfsq{ Scalar{ 0.5 } * f * f };\n"
+            << "            Scalar r{ z * polynomial(z, log_coefficients) };\n"
+            << "            Scalar low{ k * log_ln2_lo + (e - (u - Scalar{ 1 })) / u };\n"
+            << "            return k * log_ln2_hi + (f - (hfsq - (s * (hfsq + r) + low)));\n"
+            << "        }\n\n"
+            << "        inline Scalar identity(const Scalar x) { return x; }\n"
+            << "        inline Scalar sigmoid(const Scalar x) { return Scalar{ 1 } / (Scalar{ 1 } + exp(-x)); }\n"
+            << "        inline Scalar relu(const Scalar x) { return x > Scalar{ 0 } ? x : Scalar{ 0 }; }\n"
+            << "        inline Scalar softplus(const Scalar x) { return std::max(x, Scalar{ 0 }) + log1p(exp(-std::abs(x))); }\n\n"
+            << "        inline Scalar tanh(const Scalar x)\n"
+            << "        {\n"
+            << "            Scalar abs_x{ std::abs(x) };\n"
+            << "            Scalar z{ x * x };\n"
+            << "            Scalar small{ abs_x * z * (polynomial(z, tanh_p) / polynomial(z, tanh_q)) + abs_x };\n"
+            << "            Scalar large{ Scalar{ 1 } - Scalar{ 2 } / (exp(abs_x + abs_x) + Scalar{ 1 }) };\n"
+            << "            return std::copysign(abs_x < tanh_small ? small : large, x);\n"
+            << "        }\n\n"
+            << "        template <std::size_t N_IN, std::size_t N_OUT, Scalar (*ACTIVATION)(const Scalar)>\n"
+            << "        inline void layer(const Scalar (&x)[N_IN], const Scalar (&weights)[N_IN][N_OUT], const Scalar (&biases)[N_OUT], Scalar (&y)[N_OUT])\n"
+            << "        {\n"
+            << "            for (std::size_t j{ 0 }; j < N_OUT; j++)\n"
+            << "            {\n"
+            << "                y[j] = biases[j];\n"
+            << "            }\n"
+            << "            for (std::size_t k{ 0 }; k < N_IN; k++)\n"
+            << "            {\n"
+            << "                for (std::size_t j{ 0 }; j < N_OUT; j++)\n"
+            << "                {\n"
+            << "                    y[j] += x[k] * weights[k][j];\n"
+            << "                }\n"
+            << "            }\n"
+            << "            for (std::size_t j{ 0 }; j < N_OUT; j++)\n"
+            << "            {\n"
+            << "                y[j] = ACTIVATION(y[j]);\n"
+            << "            }\n"
+            << "        }\n"
+            << "    }\n\n";
+
+        outfile << "    //Scores one row of raw features\n"
+            << "    inline void predict(const Scalar (&x)[n_inputs], Scalar (&y)[n_outputs])\n    {\n";
+        for (size_t i{ 1 }; i + 1 < layers.size(); i++)
+        {
+            outfile << "        alignas(64) Scalar hidden_" << i << "[" << layers[i] << "];\n";
+        }
+        for (size_t i{ 0 }; i + 1 < layers.size(); i++)
+        {
+            std::string input{ i == 0 ? "x" : "hidden_" + std::to_string(i) };
+            std::string output{ i + 2 == layers.size() ? "y" : "hidden_" + std::to_string(i + 1) };
+            outfile << "        detail::layer<" << layers[i] << ", " << layers[i + 1] << ", detail::" << activationName(net.activations()[i]) << ">("
+                << input << ", weights_" << i << ", biases_" << i << ", " << output << ");\n";
+        }
+        outfile << "    }\n\n";
+
+        outfile << "    //Rows scored by NeuralNet::predict when the header was generated\n"
+            << "    inline constexpr std::size_t n_reference_rows{ " << reference_x.nRow() << " };\n"
+            << "    inline constexpr Scalar reference_x[" << reference_x.nRow() << "][" << reference_x.nCol() << "]";
+        writeArray(outfile, reference_x.data(), reference_x.nRow(), reference_x.nCol(), reference_x.nCol());
+        outfile << "    inline constexpr Scalar reference_y[" << reference_y.nRow() << "][" << reference_y.nCol() << "]";
+        writeArray(outfile, reference_y.data(), reference_y.nRow(), reference_y.nCol(), reference_y.nCol());
+        outfile << '\n'
+            << "    //Largest absolute difference between predict and the generating network on the reference rows\n"
+            << "    inline Scalar maxReferenceError()\n    {\n"
+            << "        Scalar largest{ 0 };\n"
+            << "        for (std::size_t row{ 0 }; row < n_reference_rows; row++)\n"
+            << "        {\n"
+            << "            Scalar y[n_outputs];\n"
+            << "            predict(reference_x[row], y);\n"
+            << "            for (std::size_t col{ 0 }; col < n_outputs; col++)\n"
+            << "            {\n"
+            << "                largest = std::max(largest, std::abs(y[col] - reference_y[row][col]));\n"
+            << "            }\n"
+            << "        }\n"
+            << "        return largest;\n"
+            << "    }\n"
+            << "}\n";
+    }
+
+    template void write(const BasicNeuralNet<float>& net, const BasicMatrix<float>& reference_x, const std::string& filename, const std::string& name_space);
+    template void write(const BasicNeuralNet<double>& net, const BasicMatrix<double>& reference_x, const std::string& filename, const std::string& name_space);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "neural_network.h"
+#include <string>
+
+namespace header_export
+{
+    //Writes a trained network as a self-contained C++20 header for embedded scoring, with nothing to link against.
+    //The header holds the layer sizes and the frozen parameters (normalization folded into the first layer) as
+    //alignas(64) constexpr arrays, and an inline predict(const T (&x)[n_inputs], T (&y)[n_outputs]) built from one
+    //layer template per size pair, so every loop bound is a compile-time constant the compiler can unroll and vectorize.
+    //Activations are written out as the accurate approximations of the library's vector kernels, in branchless scalar
+    //form without libm calls so the activation loops vectorize as well; the fast variants get the accurate ones too.
+    //The rows of reference_x are scored with net.predict and stored in the header next to maxReferenceError(), which
+    //reruns them through the generated predict and returns the largest absolute difference, so a build of the header
+    //can check itself against the network it came from. name_space must be a C++ identifier.
+    template <typename T>
+    void write(const BasicNeuralNet<T>& net, const BasicMatrix<T>& reference_x, const std::string& filename, const std::string& name_space);
+}
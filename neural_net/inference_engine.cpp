@@ -0,0 +1,100 @@
+#include "inference_engine.h"
+#include "gemm.h"
+#include "simd.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+template <typename T>
+void BasicInferenceEngine<T>::AlignedDelete::operator()(T* buffer) const
+{
+    ::operator delete[](buffer, std::align_val_t{ BUFFER_ALIGNMENT });
+}
+
+template <typename T>
+BasicInferenceEngine<T>::BasicInferenceEngine(BasicFrozenNet<T> model, const size_t max_batch)
+    : m_model{ std::move(model) }, m_max_batch{ max_batch }
+{
+    if (max_batch == 0)
+        throw std::invalid_argument("Maximum batch size must be positive!");
+
+    for (ActivationFunction activation : m_model.activations())
+    {
+        m_activation_kernels.push_back(activation_functions::kernelsFor<T>(activation));
+    }
+
+    const std::vector<size_t>& layers{ m_model.layers() };
+    size_t widest_hidden{ 1 };
+    for (size_t i{ 1 }; i + 1 < layers.size(); i++)
+    {
+        widest_hidden = std::max(widest_hidden, layers[i]);
+    }
+    for (std::unique_ptr<T[], AlignedDelete>& buffer : m_buffers)
+    {
+        buffer.reset(static_cast<T*>(::operator new[](max_batch * widest_hidden * sizeof(T), std::align_val_t{ BUFFER_ALIGNMENT })));
+    }
+}
+
+template <typename T>
+BasicInferenceEngine<T>::BasicInferenceEngine(const BasicNeuralNet<T>& net, const size_t max_batch)
+    : BasicInferenceEngine{ BasicFrozenNet<T>{ net }, max_batch }
+{
+}
+
+template <typename T>
+size_t BasicInferenceEngine<T>::maxBatch() const
+{
+    return m_max_batch;
+}
+
+template <typename T>
+size_t BasicInferenceEngine<T>::nInputs() const
+{
+    return m_model.nInputs();
+}
+
+template <typename T>
+size_t BasicInferenceEngine<T>::nOutputs() const
+{
+    return m_model.nOutputs();
+}
+
+template <typename T>
+void BasicInferenceEngine<T>::predict(std::span<const T> x, std::span<T> out)
+{
+    size_t n_rows{ x.size() / nInputs() };
+    if (x.size() % nInputs() != 0 || out.size() != n_rows * nOutputs())
+        throw std::invalid_argument("Input and output sizes do not match the network!");
+
+    for (size_t first_row{ 0 }; first_row < n_rows; first_row += m_max_batch)
+    {
+        size_t n_batch_rows{ std::min(m_max_batch, n_rows - first_row) };
+        forward(x.data() + first_row * nInputs(), n_batch_rows, out.data() + first_row * nOutputs());
+    }
+}
+
+template <typename T>
+void BasicInferenceEngine<T>::forward(const T* x, const size_t n_rows, T* out)
+{
+    //Activations stay row-major, one row per sample
+    const T* input{ x };
+    const std::vector<size_t>& layers{ m_model.layers() };
+    for (size_t i{ 0 }; i + 1 < layers.size(); i++)
+    {
+        size_t n_in{ layers[i] };
+        size_t n_out{ layers[i + 1] };
+        T* output{ i + 2 == layers.size() ? out : m_buffers[i % 2].get() };
+
+        gemm::multiply(BasicMatrixView<T>{ input, n_rows, n_in, n_in }, m_model.weights(i), output, n_out);
+        for (size_t row{ 0 }; row < n_rows; row++)
+        {
+            simd::add(output + row * n_out, output + row * n_out, m_model.biases(i), n_out);
+        }
+        m_activation_kernels[i].map(output, output, n_rows * n_out);
+
+        input = output;
+    }
+}
+
+template class BasicInferenceEngine<float>;
+template class BasicInferenceEngine<double>;
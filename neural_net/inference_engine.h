@@ -0,0 +1,46 @@
+#pragma once
+#include "frozen_net.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+//Forward pass over a frozen network, for serving.
+//Input rows are read row-major exactly as given; the frozen model already has the input normalization folded in.
+//Every buffer is sized for max_batch rows up front, so predict() does not allocate once the matrix kernels'
+//per-thread packing buffers have grown on the first call. Larger batches are scored in chunks of max_batch rows.
+//predict() reuses the engine's buffers, so each thread needs its own engine.
+template <typename T>
+class BasicInferenceEngine
+{
+private:
+    static constexpr size_t BUFFER_ALIGNMENT{ 64 };
+
+    struct AlignedDelete
+    {
+        void operator()(T* buffer) const;
+    };
+
+    BasicFrozenNet<T> m_model;
+    std::vector<ActivationKernels<T>> m_activation_kernels{};
+    size_t m_max_batch{};
+    //Hidden layers alternate between the two buffers; the output layer writes straight into the caller's output
+    std::unique_ptr<T[], AlignedDelete> m_buffers[2]{};
+
+    void forward(const T* x, const size_t n_rows, T* out);
+
+public:
+    BasicInferenceEngine(BasicFrozenNet<T> model, const size_t max_batch);
+    //Freezes the network first
+    BasicInferenceEngine(const BasicNeuralNet<T>& net, const size_t max_batch);
+
+    size_t maxBatch() const;
+    size_t nInputs() const;
+    size_t nOutputs() const;
+    //x holds whole rows of nInputs() raw, unnormalized features; out receives nOutputs() values per row
+    void predict(std::span<const T> x, std::span<T> out);
+};
+
+using InferenceEngine = BasicInferenceEngine<double>;
+using FloatInferenceEngine = BasicInferenceEngine<float>;
@@ -12,17 +12,17 @@ int main()
 
 	if (std::filesystem::exists(train_filename))
 	{
-		data_frame data_train{ read_csv(train_filename) };
+		labeled_data data_train{ read_csv(train_filename, { 0 }, { 1, 2, 3, 4 }) };
 
-		y_train = data_train.second.getCols(std::vector<size_t>{ 0 });
-		x_train = data_train.second.getCols(std::vector<size_t>{ 1, 2, 3, 4 });
+		y_train = std::move(data_train.y);
+		x_train = std::move(data_train.x);
 	}
 	if (std::filesystem::exists(test_filename))
 	{
-		data_frame data_test{ read_csv(test_filename) };
+		labeled_data data_test{ read_csv(test_filename, { 0 }, { 1, 2, 3, 4 }) };
 
-		y_test = data_test.second.getCols(std::vector<size_t>{ 0 });
-		x_test = data_test.second.getCols(std::vector<size_t>{ 1, 2, 3, 4 });
+		y_test = std::move(data_test.y);
+		x_test = std::move(data_test.x);
 	}
 	
 	std::vector<size_t> network_dimensions{ x_train.nCol(), 20, 10, 5, y_train.nCol() };
@@ -0,0 +1,146 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string& filename)
+{
+    HANDLE file{ CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Couldn't open file " + filename + "!");
+    m_file = file;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size))
+    {
+        unmap();
+        throw std::runtime_error("Couldn't read the size of " + filename + "!");
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view{ m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr };
+    if (!view)
+    {
+        unmap();
+        throw std::runtime_error("Couldn't map file " + filename + "!");
+    }
+    m_data = static_cast<const char*>(view);
+}
+
+void MappedFile::unmap()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data{ std::exchange(other.m_data, nullptr) }, m_size{ std::exchange(other.m_size, 0) },
+    m_file{ std::exchange(other.m_file, nullptr) }, m_mapping{ std::exchange(other.m_mapping, nullptr) }
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+    }
+    return *this;
+}
+#else
+MappedFile::MappedFile(const std::string& filename)
+{
+    int fd{ ::open(filename.c_str(), O_RDONLY) };
+    if (fd < 0)
+        throw std::runtime_error("Couldn't open file " + filename + "!");
+
+    struct stat status{};
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Couldn't read the size of " + filename + "!");
+    }
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size == 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    //The mapping keeps the file referenced, so the descriptor isn't needed once it exists
+    void* view{ ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0) };
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        m_size = 0;
+        throw std::runtime_error("Couldn't map file " + filename + "!");
+    }
+    ::madvise(view, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char*>(view);
+}
+
+void MappedFile::unmap()
+{
+    if (m_data)
+        ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data{ std::exchange(other.m_data, nullptr) }, m_size{ std::exchange(other.m_size, 0) }
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+const char* MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+//Read-only view of a whole file mapped into memory, on POSIX systems and Windows.
+//The mapping lives as long as the object; an empty file maps to no memory and reports size 0.
+//Failures throw std::runtime_error.
+class MappedFile
+{
+private:
+    const char* m_data{};
+    size_t m_size{};
+#if defined(_WIN32)
+    void* m_file{};
+    void* m_mapping{};
+#endif
+
+    void unmap();
+
+public:
+    explicit MappedFile(const std::string& filename);
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* data() const;
+    size_t size() const;
+};
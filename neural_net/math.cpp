@@ -1,153 +1,619 @@
 #include "math.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace activation_functions
 {
-	double identity(const double x)
+	template <typename T>
+	T identity(const T x)
 	{
 		return x;
 	}
 
-	double identity_der()
+	template <typename T>
+	T identity_der()
 	{
-		return 1.0;
+		return T{ 1 };
 	}
 
-	double sigmoid(const double x)
+	template <typename T>
+	T sigmoid(const T x)
 	{
-		return (1.0 / (1.0 + exp(-x)));
+		return (T{ 1 } / (T{ 1 } + std::exp(-x)));
 	}
 
-	double sigmoid_der(const double x)
+	template <typename T>
+	T sigmoid_der(const T x)
 	{
-		double f_x{ sigmoid(x) };
+		T f_x{ sigmoid(x) };
 		return (f_x * (1 - f_x));
 	}
 
-	double tanh(const double x)
+	template <typename T>
+	T tanh(const T x)
 	{
-		return ((exp(x) - exp(-x)) / (exp(x) + exp(-x)));
+		return std::tanh(x);
 	}
 
-	double tanh_der(const double x)
+	template <typename T>
+	T tanh_der(const T x)
 	{
-		double f_x{ tanh(x) };
+		T f_x{ tanh(x) };
 		return (1 - f_x * f_x);
 	}
 
-	double relu(const double x)
+	template <typename T>
+	T relu(const T x)
 	{
 		if (x <= 0)
-			return 0.0;
+			return T{ 0 };
 		else
 			return x;
 	}
 
-	double relu_der(const double x)
+	template <typename T>
+	T relu_der(const T x)
 	{
 		if (x <= 0)
-			return 0.0;
+			return T{ 0 };
 		else
-			return 1.0;
+			return T{ 1 };
 	}
 
-	double softplus(const double x)
+	template <typename T>
+	T softplus(const T x)
 	{
-		return std::log(1 + exp(x));
+		//log(1 + exp(x)) rewritten so exp never sees a positive argument
+		return std::max(x, T{ 0 }) + std::log1p(std::exp(-std::abs(x)));
 	}
 
-	double softplus_der(const double x)
+	template <typename T>
+	T softplus_der(const T x)
 	{
-		return (1.0 / (1.0 + exp(-x)));
+		return (T{ 1 } / (T{ 1 } + std::exp(-x)));
 	}
 
-	Matrix identity(const Matrix& x)
+	namespace
 	{
-		return x;
+		//Activations cost far more per element than the arithmetic kernels, so they are split into smaller chunks
+		constexpr size_t PARALLEL_ELEMENTS{ 1 << 12 };
+
+		//f_x is resized to match x and may be x itself
+		template <typename T, typename F>
+		void applyElementwise(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, F function)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					for (size_t i{ first }; i < last; i++)
+					{
+						f_x[i] = function(x[i]);
+					}
+				});
+		}
+
+		//Same as applyElementwise, with the derivative returned through the second argument of function
+		template <typename T, typename F>
+		void applyElementwiseWithDer(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der, F function)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			f_x_der.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					for (size_t i{ first }; i < last; i++)
+					{
+						T derivative{};
+						f_x[i] = function(x[i], derivative);
+						f_x_der[i] = derivative;
+					}
+				});
+		}
+
+		//The SIMD maps below run over contiguous chunks of the matrices; f_x may be x itself
+		template <typename T>
+		void applySigmoid(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, const simd::Accuracy accuracy)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					simd::sigmoid(f_x.data() + first, x.data() + first, last - first, accuracy);
+				});
+		}
+
+		template <typename T>
+		void applyTanh(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, const simd::Accuracy accuracy)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					simd::tanh(f_x.data() + first, x.data() + first, last - first, accuracy);
+				});
+		}
+
+		template <typename T>
+		void applySoftplus(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, const simd::Accuracy accuracy)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					simd::softplus(f_x.data() + first, x.data() + first, last - first, accuracy);
+				});
+		}
+
+		template <typename T>
+		void applySigmoidWithDer(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der, const simd::Accuracy accuracy)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			f_x_der.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					simd::sigmoid(f_x.data() + first, x.data() + first, last - first, accuracy);
+					for (size_t i{ first }; i < last; i++)
+					{
+						f_x_der[i] = f_x[i] * (1 - f_x[i]);
+					}
+				});
+		}
+
+		template <typename T>
+		void applyTanhWithDer(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der, const simd::Accuracy accuracy)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			f_x_der.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					simd::tanh(f_x.data() + first, x.data() + first, last - first, accuracy);
+					for (size_t i{ first }; i < last; i++)
+					{
+						f_x_der[i] = 1 - f_x[i] * f_x[i];
+					}
+				});
+		}
+
+		//The derivative is the logistic function of x; both come from the same exp(-|x|)
+		template <typename T>
+		void applySoftplusWithDer(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der, const simd::Accuracy accuracy)
+		{
+			f_x.resize(x.nRow(), x.nCol());
+			f_x_der.resize(x.nRow(), x.nCol());
+			parallel::forRange(x.size(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+				{
+					simd::softplusWithDer(f_x.data() + first, f_x_der.data() + first, x.data() + first, last - first, accuracy);
+				});
+		}
 	}
 
-	Matrix identity_der(const Matrix& x)
+	template <typename T>
+	BasicMatrix<T> identity(const BasicMatrix<T>& x)
 	{
-		return Matrix{ x.nRow(), x.nCol(), std::vector<double>(x.size(), 1.0) };
+		BasicMatrix<T> f_x{};
+		identity(x, f_x);
+		return f_x;
 	}
 
-	Matrix sigmoid(const Matrix& x)
+	template <typename T>
+	void identity(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
-		{
-			f_x[i] = sigmoid(x[i]);
-		}
+		applyElementwise(x, f_x, [](const T element) { return identity(element); });
+	}
+
+	template <typename T>
+	BasicMatrix<T> identity_der(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		identity_der(x, f_x);
 		return f_x;
 	}
 
-	Matrix sigmoid_der(const Matrix& x)
+	template <typename T>
+	void identity_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
-		{
-			f_x[i] = sigmoid_der(x[i]);
-		}
+		applyElementwise(x, f_x, [](const T) { return identity_der<T>(); });
+	}
+
+	template <typename T>
+	BasicMatrix<T> sigmoid(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		sigmoid(x, f_x);
 		return f_x;
 	}
 
-	Matrix tanh(const Matrix& x)
+	template <typename T>
+	void sigmoid(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
-		{
-			f_x[i] = tanh(x[i]);
-		}
+		applySigmoid(x, f_x, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	BasicMatrix<T> sigmoid_der(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		sigmoid_der(x, f_x);
 		return f_x;
 	}
 
-	Matrix tanh_der(const Matrix& x)
+	template <typename T>
+	void sigmoid_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
+		applySigmoid(x, f_x, simd::Accuracy::accurate);
+		for (size_t i{ 0 }; i < f_x.size(); i++)
 		{
-			f_x[i] = tanh_der(x[i]);
+			f_x[i] = f_x[i] * (1 - f_x[i]);
 		}
+	}
+
+	template <typename T>
+	BasicMatrix<T> tanh(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		tanh(x, f_x);
 		return f_x;
 	}
 
-	Matrix relu(const Matrix& x)
+	template <typename T>
+	void tanh(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
-		{
-			f_x[i] = relu(x[i]);
-		}
+		applyTanh(x, f_x, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	BasicMatrix<T> tanh_der(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		tanh_der(x, f_x);
 		return f_x;
 	}
 
-	Matrix relu_der(const Matrix& x)
+	template <typename T>
+	void tanh_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
+		applyTanh(x, f_x, simd::Accuracy::accurate);
+		for (size_t i{ 0 }; i < f_x.size(); i++)
 		{
-			f_x[i] = relu_der(x[i]);
+			f_x[i] = 1 - f_x[i] * f_x[i];
 		}
+	}
+
+	template <typename T>
+	BasicMatrix<T> relu(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		relu(x, f_x);
+		return f_x;
+	}
+
+	template <typename T>
+	void relu(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
+	{
+		applyElementwise(x, f_x, [](const T element) { return relu(element); });
+	}
+
+	template <typename T>
+	BasicMatrix<T> relu_der(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		relu_der(x, f_x);
+		return f_x;
+	}
+
+	template <typename T>
+	void relu_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
+	{
+		applyElementwise(x, f_x, [](const T element) { return relu_der(element); });
+	}
+
+	template <typename T>
+	BasicMatrix<T> softplus(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		softplus(x, f_x);
+		return f_x;
+	}
+
+	template <typename T>
+	void softplus(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
+	{
+		applySoftplus(x, f_x, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	BasicMatrix<T> softplus_der(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		softplus_der(x, f_x);
 		return f_x;
 	}
 
-	Matrix softplus(const Matrix& x)
+	template <typename T>
+	void softplus_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
+		applySigmoid(x, f_x, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	void identity_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applyElementwiseWithDer(x, f_x, f_x_der, [](const T element, T& derivative) { derivative = identity_der<T>(); return identity(element); });
+	}
+
+	template <typename T>
+	void sigmoid_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applySigmoidWithDer(x, f_x, f_x_der, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	void tanh_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applyTanhWithDer(x, f_x, f_x_der, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	void relu_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applyElementwiseWithDer(x, f_x, f_x_der, [](const T element, T& derivative)
+			{
+				T f{ relu(element) };
+				derivative = f > 0 ? T{ 1 } : T{ 0 };
+				return f;
+			});
+	}
+
+	template <typename T>
+	void softplus_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applySoftplusWithDer(x, f_x, f_x_der, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	BasicMatrix<T> sigmoid_fast(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		sigmoid_fast(x, f_x);
+		return f_x;
+	}
+
+	template <typename T>
+	void sigmoid_fast(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
+	{
+		applySigmoid(x, f_x, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	void sigmoid_fast_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applySigmoidWithDer(x, f_x, f_x_der, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	BasicMatrix<T> tanh_fast(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		tanh_fast(x, f_x);
+		return f_x;
+	}
+
+	template <typename T>
+	void tanh_fast(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
+	{
+		applyTanh(x, f_x, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	void tanh_fast_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applyTanhWithDer(x, f_x, f_x_der, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	BasicMatrix<T> softplus_fast(const BasicMatrix<T>& x)
+	{
+		BasicMatrix<T> f_x{};
+		softplus_fast(x, f_x);
+		return f_x;
+	}
+
+	template <typename T>
+	void softplus_fast(const BasicMatrix<T>& x, BasicMatrix<T>& f_x)
+	{
+		applySoftplus(x, f_x, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	void softplus_fast_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der)
+	{
+		applySoftplusWithDer(x, f_x, f_x_der, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	void identity(const T* x, T* f_x, const size_t n)
+	{
+		if (f_x != x)
+			std::copy(x, x + n, f_x);
+	}
+
+	template <typename T>
+	void sigmoid(const T* x, T* f_x, const size_t n)
+	{
+		simd::sigmoid(f_x, x, n, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	void tanh(const T* x, T* f_x, const size_t n)
+	{
+		simd::tanh(f_x, x, n, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	void relu(const T* x, T* f_x, const size_t n)
+	{
+		for (size_t i{ 0 }; i < n; i++)
 		{
-			f_x[i] = softplus(x[i]);
+			f_x[i] = relu(x[i]);
 		}
-		return f_x;
 	}
 
-	Matrix softplus_der(const Matrix& x)
+	template <typename T>
+	void softplus(const T* x, T* f_x, const size_t n)
+	{
+		simd::softplus(f_x, x, n, simd::Accuracy::accurate);
+	}
+
+	template <typename T>
+	void sigmoid_fast(const T* x, T* f_x, const size_t n)
+	{
+		simd::sigmoid(f_x, x, n, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	void tanh_fast(const T* x, T* f_x, const size_t n)
 	{
-		Matrix f_x{ x.nRow(), x.nCol(), std::vector<double>(x.size()) };
-		for (size_t i{ 0 }; i < x.size(); i++)
+		simd::tanh(f_x, x, n, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	void softplus_fast(const T* x, T* f_x, const size_t n)
+	{
+		simd::softplus(f_x, x, n, simd::Accuracy::fast);
+	}
+
+	template <typename T>
+	ActivationKernels<T> kernelsFor(const ActivationFunction activation)
+	{
+		using Apply = void (*)(const BasicMatrix<T>&, BasicMatrix<T>&);
+		using Map = void (*)(const T*, T*, const size_t);
+		switch (activation)
 		{
-			f_x[i] = softplus_der(x[i]);
+		case ActivationFunction::identity:
+			return { static_cast<Apply>(identity<T>), identity_with_der<T>, static_cast<Map>(identity<T>) };
+		case ActivationFunction::sigmoid:
+			return { static_cast<Apply>(sigmoid<T>), sigmoid_with_der<T>, static_cast<Map>(sigmoid<T>) };
+		case ActivationFunction::tanh:
+			return { static_cast<Apply>(tanh<T>), tanh_with_der<T>, static_cast<Map>(tanh<T>) };
+		case ActivationFunction::relu:
+			return { static_cast<Apply>(relu<T>), relu_with_der<T>, static_cast<Map>(relu<T>) };
+		case ActivationFunction::softplus:
+			return { static_cast<Apply>(softplus<T>), softplus_with_der<T>, static_cast<Map>(softplus<T>) };
+		case ActivationFunction::sigmoid_fast:
+			return { static_cast<Apply>(sigmoid_fast<T>), sigmoid_fast_with_der<T>, static_cast<Map>(sigmoid_fast<T>) };
+		case ActivationFunction::tanh_fast:
+			return { static_cast<Apply>(tanh_fast<T>), tanh_fast_with_der<T>, static_cast<Map>(tanh_fast<T>) };
+		case ActivationFunction::softplus_fast:
+			return { static_cast<Apply>(softplus_fast<T>), softplus_fast_with_der<T>, static_cast<Map>(softplus_fast<T>) };
+		default:
+			throw std::invalid_argument("Unknown activation function!");
 		}
-		return f_x;
 	}
+
+	template ActivationKernels<float> kernelsFor<float>(const ActivationFunction activation);
+	template void identity<float>(const float* x, float* f_x, const size_t n);
+	template void sigmoid<float>(const float* x, float* f_x, const size_t n);
+	template void tanh<float>(const float* x, float* f_x, const size_t n);
+	template void relu<float>(const float* x, float* f_x, const size_t n);
+	template void softplus<float>(const float* x, float* f_x, const size_t n);
+	template void sigmoid_fast<float>(const float* x, float* f_x, const size_t n);
+	template void tanh_fast<float>(const float* x, float* f_x, const size_t n);
+	template void softplus_fast<float>(const float* x, float* f_x, const size_t n);
+	template float identity<float>(const float x);
+	template float identity_der<float>();
+	template float sigmoid<float>(const float x);
+	template float sigmoid_der<float>(const float x);
+	template float tanh<float>(const float x);
+	template float tanh_der<float>(const float x);
+	template float relu<float>(const float x);
+	template float relu_der<float>(const float x);
+	template float softplus<float>(const float x);
+	template float softplus_der<float>(const float x);
+	template BasicMatrix<float> identity<float>(const BasicMatrix<float>& x);
+	template void identity<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> identity_der<float>(const BasicMatrix<float>& x);
+	template void identity_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> sigmoid<float>(const BasicMatrix<float>& x);
+	template void sigmoid<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> sigmoid_der<float>(const BasicMatrix<float>& x);
+	template void sigmoid_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> tanh<float>(const BasicMatrix<float>& x);
+	template void tanh<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> tanh_der<float>(const BasicMatrix<float>& x);
+	template void tanh_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> relu<float>(const BasicMatrix<float>& x);
+	template void relu<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> relu_der<float>(const BasicMatrix<float>& x);
+	template void relu_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> softplus<float>(const BasicMatrix<float>& x);
+	template void softplus<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template BasicMatrix<float> softplus_der<float>(const BasicMatrix<float>& x);
+	template void softplus_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template void identity_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template void sigmoid_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template void tanh_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template void relu_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template void softplus_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template BasicMatrix<float> sigmoid_fast<float>(const BasicMatrix<float>& x);
+	template void sigmoid_fast<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template void sigmoid_fast_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template BasicMatrix<float> tanh_fast<float>(const BasicMatrix<float>& x);
+	template void tanh_fast<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template void tanh_fast_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+	template BasicMatrix<float> softplus_fast<float>(const BasicMatrix<float>& x);
+	template void softplus_fast<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x);
+	template void softplus_fast_with_der<float>(const BasicMatrix<float>& x, BasicMatrix<float>& f_x, BasicMatrix<float>& f_x_der);
+
+	template ActivationKernels<double> kernelsFor<double>(const ActivationFunction activation);
+	template void identity<double>(const double* x, double* f_x, const size_t n);
+	template void sigmoid<double>(const double* x, double* f_x, const size_t n);
+	template void tanh<double>(const double* x, double* f_x, const size_t n);
+	template void relu<double>(const double* x, double* f_x, const size_t n);
+	template void softplus<double>(const double* x, double* f_x, const size_t n);
+	template void sigmoid_fast<double>(const double* x, double* f_x, const size_t n);
+	template void tanh_fast<double>(const double* x, double* f_x, const size_t n);
+	template void softplus_fast<double>(const double* x, double* f_x, const size_t n);
+	template double identity<double>(const double x);
+	template double identity_der<double>();
+	template double sigmoid<double>(const double x);
+	template double sigmoid_der<double>(const double x);
+	template double tanh<double>(const double x);
+	template double tanh_der<double>(const double x);
+	template double relu<double>(const double x);
+	template double relu_der<double>(const double x);
+	template double softplus<double>(const double x);
+	template double softplus_der<double>(const double x);
+	template BasicMatrix<double> identity<double>(const BasicMatrix<double>& x);
+	template void identity<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> identity_der<double>(const BasicMatrix<double>& x);
+	template void identity_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> sigmoid<double>(const BasicMatrix<double>& x);
+	template void sigmoid<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> sigmoid_der<double>(const BasicMatrix<double>& x);
+	template void sigmoid_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> tanh<double>(const BasicMatrix<double>& x);
+	template void tanh<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> tanh_der<double>(const BasicMatrix<double>& x);
+	template void tanh_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> relu<double>(const BasicMatrix<double>& x);
+	template void relu<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> relu_der<double>(const BasicMatrix<double>& x);
+	template void relu_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> softplus<double>(const BasicMatrix<double>& x);
+	template void softplus<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template BasicMatrix<double> softplus_der<double>(const BasicMatrix<double>& x);
+	template void softplus_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template void identity_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template void sigmoid_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template void tanh_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template void relu_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template void softplus_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template BasicMatrix<double> sigmoid_fast<double>(const BasicMatrix<double>& x);
+	template void sigmoid_fast<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template void sigmoid_fast_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template BasicMatrix<double> tanh_fast<double>(const BasicMatrix<double>& x);
+	template void tanh_fast<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template void tanh_fast_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
+	template BasicMatrix<double> softplus_fast<double>(const BasicMatrix<double>& x);
+	template void softplus_fast<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x);
+	template void softplus_fast_with_der<double>(const BasicMatrix<double>& x, BasicMatrix<double>& f_x, BasicMatrix<double>& f_x_der);
 }
\ No newline at end of file
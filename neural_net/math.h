@@ -7,29 +7,137 @@ enum class ActivationFunction
 	sigmoid,
 	tanh,
 	relu,
-	softplus
+	softplus,
+	//Same functions through the fast SIMD approximations, for inference where an error around 1e-6 is acceptable
+	sigmoid_fast,
+	tanh_fast,
+	softplus_fast
+};
+
+//Matrix-level kernels of one activation function. Networks look them up once per layer,
+//so a forward pass calls the specialized kernel directly instead of switching on every call.
+template <typename T>
+struct ActivationKernels
+{
+	void (*apply)(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	void (*apply_with_der)(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	//Serial map over n contiguous elements, for callers that manage their own buffers
+	void (*map)(const T* x, T* f_x, const size_t n);
 };
 
 namespace activation_functions
 {
-	double identity(const double x);
-	double identity_der();
-	double sigmoid(const double x);
-	double sigmoid_der(const double x);
-	double tanh(const double x);
-	double tanh_der(const double x);
-	double relu(const double x);
-	double relu_der(const double x);
-	double softplus(const double x);
-	double softplus_der(const double x);
-	Matrix identity(const Matrix& x);
-	Matrix identity_der(const Matrix& x);
-	Matrix sigmoid(const Matrix& x);
-	Matrix sigmoid_der(const Matrix& x);
-	Matrix tanh(const Matrix& x);
-	Matrix tanh_der(const Matrix& x);
-	Matrix relu(const Matrix& x);
-	Matrix relu_der(const Matrix& x);
-	Matrix softplus(const Matrix& x);
-	Matrix softplus_der(const Matrix& x);
+	//Throws std::invalid_argument for a value outside ActivationFunction
+	template <typename T>
+	ActivationKernels<T> kernelsFor(const ActivationFunction activation);
+
+	template <typename T>
+	T identity(const T x);
+	template <typename T>
+	T identity_der();
+	template <typename T>
+	T sigmoid(const T x);
+	template <typename T>
+	T sigmoid_der(const T x);
+	template <typename T>
+	T tanh(const T x);
+	template <typename T>
+	T tanh_der(const T x);
+	template <typename T>
+	T relu(const T x);
+	template <typename T>
+	T relu_der(const T x);
+	template <typename T>
+	T softplus(const T x);
+	template <typename T>
+	T softplus_der(const T x);
+	template <typename T>
+	BasicMatrix<T> identity(const BasicMatrix<T>& x);
+	template <typename T>
+	void identity(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> identity_der(const BasicMatrix<T>& x);
+	template <typename T>
+	void identity_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> sigmoid(const BasicMatrix<T>& x);
+	template <typename T>
+	void sigmoid(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> sigmoid_der(const BasicMatrix<T>& x);
+	template <typename T>
+	void sigmoid_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> tanh(const BasicMatrix<T>& x);
+	template <typename T>
+	void tanh(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> tanh_der(const BasicMatrix<T>& x);
+	template <typename T>
+	void tanh_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> relu(const BasicMatrix<T>& x);
+	template <typename T>
+	void relu(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> relu_der(const BasicMatrix<T>& x);
+	template <typename T>
+	void relu_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> softplus(const BasicMatrix<T>& x);
+	template <typename T>
+	void softplus(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	BasicMatrix<T> softplus_der(const BasicMatrix<T>& x);
+	template <typename T>
+	void softplus_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	//Activation and derivative in one pass, the derivative taken from the activation where possible.
+	//f_x and f_x_der are resized to match x; f_x may be x itself.
+	template <typename T>
+	void identity_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	template <typename T>
+	void sigmoid_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	template <typename T>
+	void tanh_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	template <typename T>
+	void relu_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	//The derivative of softplus is the logistic function; both come from one exp per element
+	template <typename T>
+	void softplus_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	//Fast-approximation variants; see simd::Accuracy
+	template <typename T>
+	BasicMatrix<T> sigmoid_fast(const BasicMatrix<T>& x);
+	template <typename T>
+	void sigmoid_fast(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	void sigmoid_fast_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	template <typename T>
+	BasicMatrix<T> tanh_fast(const BasicMatrix<T>& x);
+	template <typename T>
+	void tanh_fast(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	void tanh_fast_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	template <typename T>
+	BasicMatrix<T> softplus_fast(const BasicMatrix<T>& x);
+	template <typename T>
+	void softplus_fast(const BasicMatrix<T>& x, BasicMatrix<T>& f_x);
+	template <typename T>
+	void softplus_fast_with_der(const BasicMatrix<T>& x, BasicMatrix<T>& f_x, BasicMatrix<T>& f_x_der);
+	//Contiguous-buffer variants; f_x may equal x. They run on the calling thread.
+	template <typename T>
+	void identity(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void sigmoid(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void tanh(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void relu(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void softplus(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void sigmoid_fast(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void tanh_fast(const T* x, T* f_x, const size_t n);
+	template <typename T>
+	void softplus_fast(const T* x, T* f_x, const size_t n);
 }
\ No newline at end of file
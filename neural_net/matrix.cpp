@@ -1,6 +1,10 @@
 #include "matrix.h"
+#include "gemm.h"
+#include "simd.h"
+#include "thread_pool.h"
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 
 std::vector<size_t> sliceVector(const std::vector<size_t>& vector, const size_t first_idx, const size_t second_idx)
 {
@@ -10,7 +14,8 @@ std::vector<size_t> sliceVector(const std::vector<size_t>& vector, const size_t
     return std::vector<size_t>(vector.begin() + first_idx, vector.begin() + second_idx);
 }
 
-Matrix::Matrix(const size_t nrow, const size_t ncol, const std::vector<double>& data) //constructor, called when an object is created, don't include default vars here
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const size_t nrow, const size_t ncol, const std::vector<T>& data) //constructor, called when an object is created, don't include default vars here
     : m_nrow{ nrow }, m_ncol{ ncol }, m_data{ data }
 {
     if ((nrow * ncol) != data.size())
@@ -19,7 +24,24 @@ Matrix::Matrix(const size_t nrow, const size_t ncol, const std::vector<double>&
         throw std::invalid_argument("One dimension is zero while the other one is not!");
 }
 
-void Matrix::print(std::ostream& stream) const
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const size_t nrow, const size_t ncol, std::vector<T>&& data)
+    : m_nrow{ nrow }, m_ncol{ ncol }, m_data{ std::move(data) }
+{
+    if ((nrow * ncol) != m_data.size())
+        throw std::invalid_argument("Data size does not match the dimensions!");
+    if ((nrow == 0 && ncol > 0) || (nrow > 0 && ncol == 0))
+        throw std::invalid_argument("One dimension is zero while the other one is not!");
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrixView<T>& view)
+    : BasicMatrix{ view.materialize() }
+{
+}
+
+template <typename T>
+void BasicMatrix<T>::print(std::ostream& stream) const
 {
     stream << "Size:" << '\t' << m_data.size() << '\n';
     stream << "Cap:" << '\t' << m_data.capacity() << '\n';
@@ -39,7 +61,8 @@ void Matrix::print(std::ostream& stream) const
     stream << '\n';
 }
 
-void Matrix::printDims(std::ostream& stream) const
+template <typename T>
+void BasicMatrix<T>::printDims(std::ostream& stream) const
 {
     stream << "Size:" << '\t' << m_data.size() << '\n';
     stream << "Cap:" << '\t' << m_data.capacity() << '\n';
@@ -48,49 +71,60 @@ void Matrix::printDims(std::ostream& stream) const
     stream << '\n';
 }
 
-size_t Matrix::size() const
+template <typename T>
+size_t BasicMatrix<T>::size() const
 {
     return m_data.size();
 }
 
-size_t Matrix::nRow() const
+template <typename T>
+size_t BasicMatrix<T>::nRow() const
 {
     return m_nrow;
 }
 
-size_t Matrix::nCol() const
+template <typename T>
+size_t BasicMatrix<T>::nCol() const
 {
     return m_ncol;
 }
 
-void Matrix::clear()
+template <typename T>
+void BasicMatrix<T>::clear()
 {
     m_nrow = 0;
     m_ncol = 0;
     m_data.clear();
 }
 
-double Matrix::sumElements() const
+//The first min(old, new) elements keep their values in row-major order and any further ones are zero, so with ncol
+//unchanged the rows already there survive; trainStreaming appends chunks this way. The allocation is only replaced
+//when it is too small.
+template <typename T>
+void BasicMatrix<T>::resize(const size_t nrow, const size_t ncol)
 {
-    return accumulate(m_data.begin(), m_data.end(), 0.0);
+    if ((nrow == 0 && ncol > 0) || (nrow > 0 && ncol == 0))
+        throw std::invalid_argument("One dimension is zero while the other one is not!");
+
+    m_nrow = nrow;
+    m_ncol = ncol;
+    m_data.resize(nrow * ncol);
 }
 
-double Matrix::dotProduct(const Matrix& other_matrix) const
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::view() const
 {
-    if (m_ncol != other_matrix.m_ncol || m_nrow != other_matrix.m_nrow)
-        throw std::invalid_argument("Matrices have different dimensions!");
-
-    double result{ 0.0 };
-
-    for (size_t i{ 0 }; i < m_data.size(); i++)
-    {
-        result += m_data[i] * other_matrix.m_data[i];
-    }
+    return BasicMatrixView<T>{ *this };
+}
 
-    return result;
+template <typename T>
+T BasicMatrix<T>::sumElements() const
+{
+    return simd::sum(m_data.data(), m_data.size());
 }
 
-void Matrix::removeRow(const size_t row_idx)
+template <typename T>
+void BasicMatrix<T>::removeRow(const size_t row_idx)
 {
     if (row_idx >= m_nrow)
         throw std::invalid_argument("Index exceeds dimensions!");
@@ -108,7 +142,8 @@ void Matrix::removeRow(const size_t row_idx)
     }
 }
 
-void Matrix::removeCol(const size_t col_idx)
+template <typename T>
+void BasicMatrix<T>::removeCol(const size_t col_idx)
 {
     if (col_idx >= m_ncol)
         throw std::invalid_argument("Index exceeds dimensions!");
@@ -131,7 +166,8 @@ void Matrix::removeCol(const size_t col_idx)
     }
 }
 
-Matrix Matrix::getRow(const size_t row_idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getRow(const size_t row_idx) const
 {
     if (row_idx >= m_nrow)
         throw std::invalid_argument("Index exceeds dimensions!");
@@ -139,15 +175,16 @@ Matrix Matrix::getRow(const size_t row_idx) const
         throw std::invalid_argument("Matrix is empty!");
 
     size_t idx_start{ row_idx * m_ncol };
-    return Matrix{ 1, m_ncol, std::vector<double>(m_data.begin() + idx_start, m_data.begin() + idx_start + m_ncol) };
+    return BasicMatrix{ 1, m_ncol, std::vector<T>(m_data.begin() + idx_start, m_data.begin() + idx_start + m_ncol) };
 }
 
-Matrix Matrix::getRows(const std::vector<size_t> row_idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getRows(const std::vector<size_t> row_idx) const
 {
     if (std::max_element(row_idx.begin(), row_idx.end())[0] >= m_nrow)
         throw std::invalid_argument("Index exceeds dimensions!");
 
-    std::vector<double> result{};
+    std::vector<T> result{};
     
     for (size_t j : row_idx)
     {
@@ -157,30 +194,32 @@ Matrix Matrix::getRows(const std::vector<size_t> row_idx) const
         }
     }
 
-    return Matrix{ row_idx.size(), m_ncol, result };
+    return BasicMatrix{ row_idx.size(), m_ncol, std::move(result) };
 }
 
-Matrix Matrix::getCol(const size_t col_idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getCol(const size_t col_idx) const
 {
     if (col_idx >= m_ncol)
         throw std::invalid_argument("Index exceeds dimensions!");
     else if (m_ncol == 0)
         throw std::invalid_argument("Matrix is empty!");
 
-    std::vector<double> result(m_nrow);
+    std::vector<T> result(m_nrow);
     for (size_t i{ 0 }; i < m_nrow; i++)
     {
         result[i] = m_data[i * m_ncol + col_idx];
     }
-    return Matrix{ m_nrow, 1, result };
+    return BasicMatrix{ m_nrow, 1, std::move(result) };
 }
 
-Matrix Matrix::getCols(const std::vector<size_t> col_idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getCols(const std::vector<size_t> col_idx) const
 {
     if (std::max_element(col_idx.begin(), col_idx.end())[0] >= m_ncol)
         throw std::invalid_argument("Index exceeds dimensions!");
     
-    std::vector<double> result{};
+    std::vector<T> result{};
     for (size_t i{ 0 }; i < m_nrow; i++)
     {
         for (size_t j : col_idx)
@@ -188,41 +227,47 @@ Matrix Matrix::getCols(const std::vector<size_t> col_idx) const
             result.push_back(this->operator()(i, j));
         }
     }
-    return Matrix{ m_nrow, col_idx.size(), result };
+    return BasicMatrix{ m_nrow, col_idx.size(), std::move(result) };
 }
 
-double& Matrix::at(const size_t row_idx, const size_t col_idx)
+template <typename T>
+T& BasicMatrix<T>::at(const size_t row_idx, const size_t col_idx)
 {
     if (row_idx >= m_nrow || col_idx >= m_ncol)
         throw std::invalid_argument("Index exceeds dimensions!");
     return m_data.at(row_idx * m_ncol + col_idx);
 }
 
-double& Matrix::at(const size_t idx)
+template <typename T>
+T& BasicMatrix<T>::at(const size_t idx)
 {
     return m_data.at(idx);
 }
 
-const double& Matrix::at(const size_t row_idx, const size_t col_idx) const
+template <typename T>
+const T& BasicMatrix<T>::at(const size_t row_idx, const size_t col_idx) const
 {
     if (row_idx >= m_nrow || col_idx >= m_ncol)
         throw std::invalid_argument("Index exceeds dimensions!");
     return m_data.at(row_idx * m_ncol + col_idx);
 }
 
-const double& Matrix::at(const size_t idx) const
+template <typename T>
+const T& BasicMatrix<T>::at(const size_t idx) const
 {
     return m_data.at(idx);
 }
 
-bool Matrix::isSquare() const
+template <typename T>
+bool BasicMatrix<T>::isSquare() const
 {
     return (m_nrow == m_ncol);
 }
 
-Matrix Matrix::transpose() const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::transpose() const
 {
-    Matrix result{ m_ncol, m_nrow, std::vector<double>(m_data.size()) };
+    BasicMatrix result{ m_ncol, m_nrow, std::vector<T>(m_data.size()) };
     for (int i{ 0 }; i < m_nrow; i++)
     {
         for (int j{ 0 }; j < m_ncol; j++)
@@ -233,256 +278,254 @@ Matrix Matrix::transpose() const
     return result;
 }
 
-void Matrix::transposeMe()
+template <typename T>
+void BasicMatrix<T>::transposeMe()
 {
     *this = this->transpose();
 }
 
-void Matrix::zeroMe()
-{
-    m_data = std::vector<double>(m_data.size(), 0.0);
-}
-
-Matrix Matrix::hadamardProduct(const Matrix& other_matrix) const
-{
-    if (m_ncol != other_matrix.m_ncol || m_nrow != other_matrix.m_nrow)
-        throw std::invalid_argument("Matrices have different dimensions!");
-
-    Matrix result{ m_nrow, m_ncol, std::vector<double>(m_data.size()) };
-
-    for (size_t i{ 0 }; i < result.size(); i++)
-    {
-        result[i] = m_data[i]*other_matrix.m_data[i];
-    }
-
-    return result;
-}
-
-Matrix Matrix::hadamardProductColumnwise(const Matrix& other_matrix) const
+template <typename T>
+void BasicMatrix<T>::zeroMe()
 {
-    if (m_nrow != other_matrix.m_nrow || other_matrix.m_ncol != 1)
-        throw std::invalid_argument("Matrices have different dimensions!");
-
-    Matrix result{ m_nrow, m_ncol, std::vector<double>(m_data.size()) };
-
-    for (size_t i{ 0 }; i < m_nrow; i++)
-    {
-        for (size_t j{ 0 }; j < m_ncol; j++)
-        {
-            result.m_data[i * m_ncol + j] = m_data[i * m_ncol + j] * other_matrix.m_data[i];
-        }
-    }
-
-    return result;
+    m_data = std::vector<T>(m_data.size(), 0.0);
 }
 
-Matrix Matrix::zeroButOne(const size_t idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::zeroButOne(const size_t idx) const
 {
-    Matrix result{ m_nrow, m_ncol, std::vector<double>(m_data.size(), 0.0) };
+    BasicMatrix result{ m_nrow, m_ncol, std::vector<T>(m_data.size(), 0.0) };
     result[idx] = m_data.at(idx);
     return result;
 }
 
-Matrix Matrix::zeroButOne(const size_t row_idx, const size_t col_idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::zeroButOne(const size_t row_idx, const size_t col_idx) const
 {
     if (row_idx >= m_nrow || col_idx >= m_ncol)
         throw std::invalid_argument("Index exceeds dimensions!");
 
-    Matrix result{ m_nrow, m_ncol, std::vector<double>(m_data.size(), 0.0) };
+    BasicMatrix result{ m_nrow, m_ncol, std::vector<T>(m_data.size(), 0.0) };
     result[row_idx * m_ncol + col_idx] =  m_data.at(row_idx * m_ncol + col_idx);
     return result;
 }
 
-Matrix Matrix::zeroButOneRow(const size_t row_idx) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::zeroButOneRow(const size_t row_idx) const
 {
     if (row_idx >= m_nrow)
         throw std::invalid_argument("Index exceeds dimensions!");
 
-    std::vector<double> result(m_data.size(), 0.0);
+    std::vector<T> result(m_data.size(), 0.0);
     size_t idx_start{ row_idx * m_ncol };
 
-    std::vector<double> src{ std::vector<double>(m_data.begin() + idx_start, m_data.begin() + idx_start + m_ncol) };
+    std::vector<T> src{ std::vector<T>(m_data.begin() + idx_start, m_data.begin() + idx_start + m_ncol) };
     std::copy(src.begin(), src.end(), result.begin() + idx_start);
 
-    return Matrix{ m_nrow, m_ncol, result };
+    return BasicMatrix{ m_nrow, m_ncol, std::move(result) };
 }
 
-std::vector<double> Matrix::columnwiseMean() const
+template <typename T>
+std::vector<T> BasicMatrix<T>::columnwiseMean() const
 {
     if (m_ncol == 0)
         throw std::invalid_argument("Zero columns!");
 
-    std::vector<double> result{};
+    std::vector<T> result{};
     for (size_t i{ 0 }; i < m_ncol; i++)
     {
-        std::vector<double> cur_col{ this->getCol(i).m_data };
-        double average{ std::accumulate(cur_col.begin(), cur_col.end(), 0.0) / static_cast<double>(cur_col.size()) };
-        result.push_back(average);
+        result.push_back(view().col(i).sumElements() / static_cast<T>(m_nrow));
     }
     return result;
 }
 
-std::vector<double> Matrix::columnwiseStdDev() const
+template <typename T>
+std::vector<T> BasicMatrix<T>::columnwiseStdDev() const
 {
     if (m_ncol == 0)
         throw std::invalid_argument("Zero columns!");
 
-    std::vector<double> result{};
+    std::vector<T> result{};
     for (size_t i{ 0 }; i < m_ncol; i++)
     {
-        std::vector<double> cur_col{ this->getCol(i).m_data };
-        double average{ std::accumulate(cur_col.begin(), cur_col.end(), 0.0) / static_cast<double>(cur_col.size()) };
-        double sum{ 0.0 };
-        for (double& element : cur_col)
+        T average{ view().col(i).sumElements() / static_cast<T>(m_nrow) };
+        T sum{ 0 };
+        for (size_t j{ 0 }; j < m_nrow; j++)
         {
-            element -= average;
+            T element{ m_data[j * m_ncol + i] - average };
             sum += element * element;
         }
-        result.push_back(sqrt(sum / cur_col.size()));
+        result.push_back(std::sqrt(sum / static_cast<T>(m_nrow)));
     }
     return result;
 }
 
-void Matrix::operator+=(const Matrix& other_matrix)
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::rowwiseSum() const
 {
-    if (m_ncol != other_matrix.m_ncol || m_nrow != other_matrix.m_nrow)
-        throw std::invalid_argument("Matrices have different dimensions!");
-
-    for (size_t i{ 0 }; i < m_data.size(); i++)
-    {
-        m_data[i] += other_matrix.m_data[i];
-    }
+    BasicMatrix result{};
+    rowwiseSumInto(view(), result);
+    return result;
 }
 
-void Matrix::operator-=(const Matrix& other_matrix)
+template <typename T>
+void BasicMatrix<T>::operator+=(const BasicMatrixView<T>& other_matrix)
 {
-    if (m_ncol != other_matrix.m_ncol || m_nrow != other_matrix.m_nrow)
+    if (m_ncol != other_matrix.nCol() || m_nrow != other_matrix.nRow())
         throw std::invalid_argument("Matrices have different dimensions!");
 
-    for (size_t i{ 0 }; i < m_data.size(); i++)
+    if (other_matrix.isContiguous())
     {
-        m_data[i] -= other_matrix.m_data[i];
+        parallel::forRange(m_data.size(), expr::PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+            {
+                simd::add(m_data.data() + first, m_data.data() + first, other_matrix.data() + first, last - first);
+            });
+        return;
     }
-}
 
-void Matrix::operator*=(const double multiplier)
-{
-    for (size_t i{ 0 }; i < m_data.size(); i++)
+    for (size_t i{ 0 }; i < m_nrow; i++)
     {
-        m_data[i] *= multiplier;
+        for (size_t j{ 0 }; j < m_ncol; j++)
+        {
+            m_data[i * m_ncol + j] += other_matrix(i, j);
+        }
     }
 }
 
-void Matrix::operator+=(const double add_me)
+template <typename T>
+void BasicMatrix<T>::operator-=(const BasicMatrixView<T>& other_matrix)
 {
-    for (size_t i{ 0 }; i < m_data.size(); i++)
+    if (m_ncol != other_matrix.nCol() || m_nrow != other_matrix.nRow())
+        throw std::invalid_argument("Matrices have different dimensions!");
+
+    if (other_matrix.isContiguous())
     {
-        m_data[i] += add_me;
+        parallel::forRange(m_data.size(), expr::PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+            {
+                simd::subtract(m_data.data() + first, m_data.data() + first, other_matrix.data() + first, last - first);
+            });
+        return;
     }
-}
 
-void Matrix::operator-=(const double subtract_me)
-{
-    for (size_t i{ 0 }; i < m_data.size(); i++)
+    for (size_t i{ 0 }; i < m_nrow; i++)
     {
-        m_data[i] -= subtract_me;
+        for (size_t j{ 0 }; j < m_ncol; j++)
+        {
+            m_data[i * m_ncol + j] -= other_matrix(i, j);
+        }
     }
 }
 
-Matrix Matrix::operator+(const double add_me) const
+template <typename T>
+void BasicMatrix<T>::operator*=(const T multiplier)
 {
-    Matrix result{ *this };
-    result += add_me;
-    return result;
+    parallel::forRange(m_data.size(), expr::PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+        {
+            simd::scale(m_data.data() + first, m_data.data() + first, multiplier, last - first);
+        });
 }
 
-Matrix Matrix::operator+(const Matrix& other_matrix) const
+template <typename T>
+void BasicMatrix<T>::operator+=(const T add_me)
 {
-    Matrix result{ *this };
-    result += other_matrix;
-    return result;
+    parallel::forRange(m_data.size(), expr::PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+        {
+            simd::addScalar(m_data.data() + first, m_data.data() + first, add_me, last - first);
+        });
 }
 
-Matrix Matrix::operator-(const double subtract_me) const
+template <typename T>
+void BasicMatrix<T>::operator-=(const T subtract_me)
 {
-    Matrix result{ *this };
-    result -= subtract_me;
-    return result;
+    parallel::forRange(m_data.size(), expr::PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+        {
+            simd::addScalar(m_data.data() + first, m_data.data() + first, -subtract_me, last - first);
+        });
 }
 
-Matrix Matrix::operator-(const Matrix& other_matrix) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrixView<T>& other_matrix) const
 {
-    Matrix result{ *this };
-    result -= other_matrix;
-    return result;
+    return view() * other_matrix;
 }
 
-Matrix Matrix::operator*(const double multiplier) const
+namespace
 {
-    Matrix result{ *this };
-    result *= multiplier;
-    return result;
+    //Checked before resizing, since views onto the result would dangle if its buffer were reallocated
+    template <typename T>
+    void checkResultOverlap(const BasicMatrixView<T>& operand, const BasicMatrix<T>& result)
+    {
+        if (operand.overlaps(result.data(), result.data() + result.size()))
+            throw std::invalid_argument("Result overlaps an operand!");
+    }
 }
 
-Matrix Matrix::operator*(const Matrix& other_matrix) const
+template <typename T>
+void multiplyInto(const ViewArg<T>& left_view, const ViewArg<T>& right_view, BasicMatrix<T>& result)
 {
-    if (m_ncol != other_matrix.m_nrow)
+    if (left_view.nCol() != right_view.nRow())
         throw std::invalid_argument("Matrices are not compatible for multiplication!");
+    checkResultOverlap(left_view, result);
+    checkResultOverlap(right_view, result);
 
-    Matrix result{ m_nrow, other_matrix.m_ncol, std::vector<double>(m_nrow * other_matrix.m_ncol) };
+    result.resize(left_view.nRow(), right_view.nCol());
+    gemm::multiply(left_view, right_view, result.data(), result.nCol());
+}
 
-    for (size_t i{ 0 }; i < m_nrow; i++)
-    {
-        for (size_t j{ 0 }; j < other_matrix.m_ncol; j++)
-        {
-            double element_value{ 0.0 };
+template <typename T>
+void hadamardInto(const ViewArg<T>& left_view, const ViewArg<T>& right_view, BasicMatrix<T>& result)
+{
+    checkResultOverlap(left_view, result);
+    checkResultOverlap(right_view, result);
 
-            for (size_t k{ 0 }; k < m_ncol; k++)
-            {
-                element_value += m_data[i * m_ncol + k] * other_matrix.m_data[k * other_matrix.m_ncol + j];
-            }
+    result = expr::binary<expr::Multiply>(left_view, right_view);
+}
 
-            result.m_data[i * other_matrix.m_ncol + j] = element_value;
-        }
-    }
+template <typename T>
+void addColumnwiseInto(const ViewArg<T>& left_view, const ViewArg<T>& column_view, BasicMatrix<T>& result)
+{
+    checkResultOverlap(left_view, result);
+    checkResultOverlap(column_view, result);
 
-    return result;
+    result = expr::columnwise<expr::Add>(left_view, column_view);
 }
 
-Matrix Matrix::addColumnwise(const Matrix& other_matrix) const
+template <typename T>
+void transposeInto(const ViewArg<T>& view, BasicMatrix<T>& result)
 {
-    if (m_nrow != other_matrix.m_nrow || other_matrix.m_ncol != 1)
-        throw std::invalid_argument("Matrices have different dimensions!");
+    checkResultOverlap(view, result);
 
-    Matrix result{ *this };
-
-    for (size_t i{ 0 }; i < m_nrow; i++)
+    result.resize(view.nCol(), view.nRow());
+    for (size_t i{ 0 }; i < view.nRow(); i++)
     {
-        for (size_t j{ 0 }; j < m_ncol; j++)
+        for (size_t j{ 0 }; j < view.nCol(); j++)
         {
-            result(i, j) += other_matrix[i];
+            result(j, i) = view(i, j);
         }
     }
-
-    return result;
 }
 
-double& Matrix::operator[](const size_t idx)
+template <typename T>
+void rowwiseSumInto(const ViewArg<T>& view, BasicMatrix<T>& result)
 {
-    return m_data[idx];
-}
+    checkResultOverlap(view, result);
 
-const double& Matrix::operator[](const size_t idx) const
-{
-    return m_data[idx];
+    result.resize(view.nRow(), view.size() == 0 ? 0 : 1);
+    for (size_t i{ 0 }; i < view.nRow(); i++)
+    {
+        result[i] = view.row(i).sumElements();
+    }
 }
 
-double& Matrix::operator()(const size_t row_idx, const size_t col_idx)
-{
-    return m_data[row_idx * m_ncol + col_idx];
-}
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
 
-const double& Matrix::operator()(const size_t row_idx, const size_t col_idx) const
-{
-    return m_data[row_idx * m_ncol + col_idx];
-}
\ No newline at end of file
+template void multiplyInto(const ViewArg<float>&, const ViewArg<float>&, BasicMatrix<float>&);
+template void multiplyInto(const ViewArg<double>&, const ViewArg<double>&, BasicMatrix<double>&);
+template void hadamardInto(const ViewArg<float>&, const ViewArg<float>&, BasicMatrix<float>&);
+template void hadamardInto(const ViewArg<double>&, const ViewArg<double>&, BasicMatrix<double>&);
+template void addColumnwiseInto(const ViewArg<float>&, const ViewArg<float>&, BasicMatrix<float>&);
+template void addColumnwiseInto(const ViewArg<double>&, const ViewArg<double>&, BasicMatrix<double>&);
+template void transposeInto(const ViewArg<float>&, BasicMatrix<float>&);
+template void transposeInto(const ViewArg<double>&, BasicMatrix<double>&);
+template void rowwiseSumInto(const ViewArg<float>&, BasicMatrix<float>&);
+template void rowwiseSumInto(const ViewArg<double>&, BasicMatrix<double>&);
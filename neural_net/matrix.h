@@ -1,18 +1,37 @@
 #pragma once
 #include <vector>
 #include <iostream>
+#include <type_traits>
+#include "matrix_view.h"
+#include "matrix_expr.h"
 
 std::vector<size_t> sliceVector(const std::vector<size_t>& vector, const size_t first_idx, const size_t second_idx);
 
-class Matrix
+template <typename T>
+class BasicMatrix
 {
 private:
     size_t m_nrow{};
     size_t m_ncol{};
-    std::vector<double> m_data{};
+    std::vector<T> m_data{};
 
 public:
-    Matrix(const size_t nrow = 0, const size_t ncol = 0, const std::vector<double>& data = std::vector<double>{});
+    using value_type = T;
+
+    BasicMatrix(const size_t nrow = 0, const size_t ncol = 0, const std::vector<T>& data = std::vector<T>{});
+    BasicMatrix(const size_t nrow, const size_t ncol, std::vector<T>&& data);
+    explicit BasicMatrix(const BasicMatrixView<T>& view);
+    template <typename U>
+    explicit BasicMatrix(const BasicMatrix<U>& other_matrix);
+    template <typename E>
+    BasicMatrix(const expr::Node<E>& expression);
+    template <typename E>
+    BasicMatrix(expr::Node<E>&& expression);
+
+    template <typename E>
+    BasicMatrix& operator=(const expr::Node<E>& expression);
+    template <typename E>
+    BasicMatrix& operator=(expr::Node<E>&& expression);
 
     void print(std::ostream& stream = std::cout) const;
     void printDims(std::ostream& stream = std::cout) const;
@@ -20,44 +39,274 @@ public:
     size_t nRow() const;
     size_t nCol() const;
     void clear();
-    double sumElements() const;
-    double dotProduct(const Matrix& other_matrix) const;
+    //Keeps the row-major prefix of the elements, so growing nrow with ncol unchanged keeps the existing rows
+    void resize(const size_t nrow, const size_t ncol);
+    T* data();
+    const T* data() const;
+    BasicMatrixView<T> view() const;
+    T sumElements() const;
+    template <expr::Operand R>
+    T dotProduct(R&& other_matrix) const;
     void removeRow(const size_t row_idx);
     void removeCol(const size_t col_idx);
-    Matrix getRow(const size_t row_idx) const;
-    Matrix getRows(const std::vector<size_t> row_idx) const;
-    Matrix getCol(const size_t col_idx) const;
-    Matrix getCols(const std::vector<size_t> col_idx) const;
-    double& at(const size_t row_idx, const size_t col_idx);
-    double& at(const size_t idx);
-    const double& at(const size_t row_idx, const size_t col_idx) const;
-    const double& at(const size_t idx) const;
+    BasicMatrix getRow(const size_t row_idx) const;
+    BasicMatrix getRows(const std::vector<size_t> row_idx) const;
+    BasicMatrix getCol(const size_t col_idx) const;
+    BasicMatrix getCols(const std::vector<size_t> col_idx) const;
+    T& at(const size_t row_idx, const size_t col_idx);
+    T& at(const size_t idx);
+    const T& at(const size_t row_idx, const size_t col_idx) const;
+    const T& at(const size_t idx) const;
     bool isSquare() const;
-    Matrix transpose() const;
+    BasicMatrix transpose() const;
     void transposeMe();
     void zeroMe();
-    Matrix hadamardProduct(const Matrix& other_matrix) const;
-    Matrix hadamardProductColumnwise(const Matrix& other_matrix) const;
-    Matrix zeroButOne(const size_t idx) const;
-    Matrix zeroButOne(const size_t row_idx, const size_t col_idx) const;
-    Matrix zeroButOneRow(const size_t row_idx) const;
-    std::vector<double> columnwiseMean() const;
-    std::vector<double> columnwiseStdDev() const;
-
-    void operator+=(const Matrix& other_matrix);
-    void operator-=(const Matrix& other_matrix);
-    void operator*=(const double multiplier);
-    void operator+=(const double add_me);
-    void operator-=(const double subtract_me);
-    Matrix operator+(const double add_me) const;
-    Matrix operator+(const Matrix& other_matrix) const;
-    Matrix operator-(const double subtract_me) const;
-    Matrix operator-(const Matrix& other_matrix) const;
-    Matrix operator*(const double multiplier) const;
-    Matrix operator*(const Matrix& other_matrix) const;
-    Matrix addColumnwise(const Matrix& other_matrix) const;
-    double& operator[](const size_t idx);
-    const double& operator[](const size_t idx) const;
-    double& operator()(const size_t row_idx, const size_t col_idx);
-    const double& operator()(const size_t row_idx, const size_t col_idx) const;
-};
\ No newline at end of file
+    template <expr::Operand R>
+    auto hadamardProduct(R&& other_matrix) const&;
+    template <expr::Operand R>
+    auto hadamardProduct(R&& other_matrix) &&;
+    template <expr::Operand R>
+    auto hadamardProductColumnwise(R&& other_matrix) const&;
+    template <expr::Operand R>
+    auto hadamardProductColumnwise(R&& other_matrix) &&;
+    BasicMatrix zeroButOne(const size_t idx) const;
+    BasicMatrix zeroButOne(const size_t row_idx, const size_t col_idx) const;
+    BasicMatrix zeroButOneRow(const size_t row_idx) const;
+    std::vector<T> columnwiseMean() const;
+    std::vector<T> columnwiseStdDev() const;
+    BasicMatrix rowwiseSum() const;
+
+    //Operands taking a BasicMatrixView<T> accept a BasicMatrix as well; a view operand must not overlap *this.
+    //Element-wise +, - and scalar * are the lazy operators in matrix_expr.h.
+    void operator+=(const BasicMatrixView<T>& other_matrix);
+    void operator-=(const BasicMatrixView<T>& other_matrix);
+    template <typename E>
+    void operator+=(const expr::Node<E>& expression);
+    template <typename E>
+    void operator-=(const expr::Node<E>& expression);
+    void operator*=(const T multiplier);
+    void operator+=(const T add_me);
+    void operator-=(const T subtract_me);
+    BasicMatrix operator*(const BasicMatrixView<T>& other_matrix) const;
+    template <expr::Operand R>
+    auto addColumnwise(R&& other_matrix) const&;
+    template <expr::Operand R>
+    auto addColumnwise(R&& other_matrix) &&;
+    T& operator[](const size_t idx);
+    const T& operator[](const size_t idx) const;
+    T& operator()(const size_t row_idx, const size_t col_idx);
+    const T& operator()(const size_t row_idx, const size_t col_idx) const;
+};
+
+using Matrix = BasicMatrix<double>;
+using FloatMatrix = BasicMatrix<float>;
+
+//Output-parameter variants: the result is resized to fit and keeps its allocation whenever it is large enough.
+//The result must not overlap an operand.
+//The scalar type is taken from the result, so a Matrix passes as an operand as well.
+template <typename T>
+using ViewArg = std::type_identity_t<BasicMatrixView<T>>;
+
+template <typename T>
+void multiplyInto(const ViewArg<T>& left_view, const ViewArg<T>& right_view, BasicMatrix<T>& result);
+template <typename T>
+void hadamardInto(const ViewArg<T>& left_view, const ViewArg<T>& right_view, BasicMatrix<T>& result);
+template <typename T>
+void addColumnwiseInto(const ViewArg<T>& left_view, const ViewArg<T>& column_view, BasicMatrix<T>& result);
+template <typename T>
+void transposeInto(const ViewArg<T>& view, BasicMatrix<T>& result);
+template <typename T>
+void rowwiseSumInto(const ViewArg<T>& view, BasicMatrix<T>& result);
+
+//Element access is defined here so fused expression loops can inline it
+template <typename T>
+inline T* BasicMatrix<T>::data()
+{
+    return m_data.data();
+}
+
+template <typename T>
+inline const T* BasicMatrix<T>::data() const
+{
+    return m_data.data();
+}
+
+template <typename T>
+inline T& BasicMatrix<T>::operator[](const size_t idx)
+{
+    return m_data[idx];
+}
+
+template <typename T>
+inline const T& BasicMatrix<T>::operator[](const size_t idx) const
+{
+    return m_data[idx];
+}
+
+template <typename T>
+inline T& BasicMatrix<T>::operator()(const size_t row_idx, const size_t col_idx)
+{
+    return m_data[row_idx * m_ncol + col_idx];
+}
+
+template <typename T>
+inline const T& BasicMatrix<T>::operator()(const size_t row_idx, const size_t col_idx) const
+{
+    return m_data[row_idx * m_ncol + col_idx];
+}
+
+template <typename T>
+template <typename U>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix<U>& other_matrix)
+    : m_nrow{ other_matrix.nRow() }, m_ncol{ other_matrix.nCol() }, m_data(other_matrix.size())
+{
+    for (size_t i{ 0 }; i < m_data.size(); i++)
+    {
+        m_data[i] = static_cast<T>(other_matrix[i]);
+    }
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>::BasicMatrix(const expr::Node<E>& expression)
+    : m_nrow{ expression.derived().nRow() }, m_ncol{ expression.derived().nCol() }, m_data(expression.derived().size())
+{
+    expr::evaluate(expression.derived(), m_data.data());
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>::BasicMatrix(expr::Node<E>&& expression)
+{
+    E& source{ static_cast<E&>(expression) };
+    BasicMatrix* storage{ source.ownedStorage() };
+
+    //Evaluate into the buffer of a moved-in operand instead of allocating
+    if (storage && !source.overlaps(storage->data(), storage->data() + storage->size()))
+    {
+        expr::evaluate(source, storage->data());
+        *this = std::move(*storage);
+    }
+    else
+    {
+        *this = BasicMatrix{ static_cast<const expr::Node<E>&>(expression) };
+    }
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const expr::Node<E>& expression)
+{
+    const E& source{ expression.derived() };
+    size_t size{ source.size() };
+
+    //Evaluate into the current allocation unless it is too small or the expression reads it out of order
+    if (size <= m_data.capacity() && !source.overlaps(m_data.data(), m_data.data() + size))
+    {
+        resize(source.nRow(), source.nCol());
+        expr::evaluate(source, m_data.data());
+    }
+    else
+    {
+        *this = BasicMatrix{ expression };
+    }
+
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(expr::Node<E>&& expression)
+{
+    const E& source{ expression.derived() };
+    size_t size{ source.size() };
+
+    if (size <= m_data.capacity() && !source.overlaps(m_data.data(), m_data.data() + size))
+    {
+        resize(source.nRow(), source.nCol());
+        expr::evaluate(source, m_data.data());
+    }
+    else
+    {
+        *this = BasicMatrix{ std::move(expression) };
+    }
+
+    return *this;
+}
+
+template <typename T>
+template <expr::Operand R>
+T BasicMatrix<T>::dotProduct(R&& other_matrix) const
+{
+    return expr::dotProduct(expr::leaf(*this), expr::leaf(std::forward<R>(other_matrix)));
+}
+
+template <typename T>
+template <expr::Operand R>
+auto BasicMatrix<T>::hadamardProduct(R&& other_matrix) const&
+{
+    return expr::binary<expr::Multiply>(*this, std::forward<R>(other_matrix));
+}
+
+template <typename T>
+template <expr::Operand R>
+auto BasicMatrix<T>::hadamardProduct(R&& other_matrix) &&
+{
+    return expr::binary<expr::Multiply>(std::move(*this), std::forward<R>(other_matrix));
+}
+
+template <typename T>
+template <expr::Operand R>
+auto BasicMatrix<T>::hadamardProductColumnwise(R&& other_matrix) const&
+{
+    return expr::columnwise<expr::Multiply>(*this, std::forward<R>(other_matrix));
+}
+
+template <typename T>
+template <expr::Operand R>
+auto BasicMatrix<T>::hadamardProductColumnwise(R&& other_matrix) &&
+{
+    return expr::columnwise<expr::Multiply>(std::move(*this), std::forward<R>(other_matrix));
+}
+
+template <typename T>
+template <expr::Operand R>
+auto BasicMatrix<T>::addColumnwise(R&& other_matrix) const&
+{
+    return expr::columnwise<expr::Add>(*this, std::forward<R>(other_matrix));
+}
+
+template <typename T>
+template <expr::Operand R>
+auto BasicMatrix<T>::addColumnwise(R&& other_matrix) &&
+{
+    return expr::columnwise<expr::Add>(std::move(*this), std::forward<R>(other_matrix));
+}
+
+template <typename T>
+template <typename E>
+void BasicMatrix<T>::operator+=(const expr::Node<E>& expression)
+{
+    const E& source{ expression.derived() };
+    if (m_ncol != source.nCol() || m_nrow != source.nRow())
+        throw std::invalid_argument("Matrices have different dimensions!");
+
+    if (source.overlaps(m_data.data(), m_data.data() + m_data.size()))
+        *this += BasicMatrix{ expression };
+    else
+        expr::evaluateCompound<expr::Add>(source, m_data.data());
+}
+
+template <typename T>
+template <typename E>
+void BasicMatrix<T>::operator-=(const expr::Node<E>& expression)
+{
+    const E& source{ expression.derived() };
+    if (m_ncol != source.nCol() || m_nrow != source.nRow())
+        throw std::invalid_argument("Matrices have different dimensions!");
+
+    if (source.overlaps(m_data.data(), m_data.data() + m_data.size()))
+        *this -= BasicMatrix{ expression };
+    else
+        expr::evaluateCompound<expr::Subtract>(source, m_data.data());
+}
\ No newline at end of file
@@ -0,0 +1,537 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "matrix_view.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+//Lazily evaluated element-wise matrix arithmetic.
+//+, -, scalar *, hadamardProduct, hadamardProductColumnwise and addColumnwise build a tree of nodes instead of
+//temporaries; the whole tree is evaluated in one loop when it is assigned to a Matrix or reduced.
+//Matrix lvalues are held by reference and Matrix rvalues by value, so an expression never dangles on a temporary.
+//A Matrix built from an expression holding a Matrix rvalue of the same shape takes over its buffer.
+//
+//Every node answers two aliasing questions about a destination range [first, last):
+//reads() - whether any operand storage lies in it
+//overlaps() - whether evaluating into it row-major could read an element after it has been overwritten
+namespace expr
+{
+    struct NodeTag
+    {
+    };
+
+    template <typename T>
+    concept IsNode = std::is_base_of_v<NodeTag, std::remove_cvref_t<T>>;
+
+    template <typename T>
+    struct IsMatrixType : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct IsMatrixType<BasicMatrix<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct IsViewType : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct IsViewType<BasicMatrixView<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    concept Operand = IsMatrixType<std::remove_cvref_t<T>>::value || IsViewType<std::remove_cvref_t<T>>::value || IsNode<T>;
+
+    //Base of every expression; the member functions mirror the ones Matrix offers
+    template <typename Derived>
+    class Node : public NodeTag
+    {
+    public:
+        const Derived& derived() const { return static_cast<const Derived&>(*this); }
+        Derived&& moved() { return static_cast<Derived&&>(*this); }
+
+        size_t size() const { return derived().nRow() * derived().nCol(); }
+
+        template <Operand R>
+        auto hadamardProduct(R&& other_matrix) const&;
+        template <Operand R>
+        auto hadamardProduct(R&& other_matrix) &&;
+        template <Operand R>
+        auto hadamardProductColumnwise(R&& other_matrix) const&;
+        template <Operand R>
+        auto hadamardProductColumnwise(R&& other_matrix) &&;
+        template <Operand R>
+        auto addColumnwise(R&& other_matrix) const&;
+        template <Operand R>
+        auto addColumnwise(R&& other_matrix) &&;
+        template <Operand R>
+        auto dotProduct(R&& other_matrix) const;
+        auto sumElements() const;
+    };
+
+    template <typename T>
+    bool intersects(const T* first, const T* last, const T* other_first, const T* other_last)
+    {
+        std::less<const T*> less{};
+        return first != last && other_first != other_last && less(first, other_last) && less(other_first, last);
+    }
+
+    struct Add
+    {
+        template <typename T>
+        static T apply(const T a, const T b) { return a + b; }
+        template <typename T>
+        static void kernel(T* dst, const T* a, const T* b, const size_t n) { simd::add(dst, a, b, n); }
+        template <typename T>
+        static void scalarKernel(T* dst, const T* a, const T s, const size_t n) { simd::addScalar(dst, a, s, n); }
+    };
+
+    struct Subtract
+    {
+        template <typename T>
+        static T apply(const T a, const T b) { return a - b; }
+        template <typename T>
+        static void kernel(T* dst, const T* a, const T* b, const size_t n) { simd::subtract(dst, a, b, n); }
+        template <typename T>
+        static void scalarKernel(T* dst, const T* a, const T s, const size_t n) { simd::addScalar(dst, a, -s, n); }
+    };
+
+    struct Multiply
+    {
+        template <typename T>
+        static T apply(const T a, const T b) { return a * b; }
+        template <typename T>
+        static void kernel(T* dst, const T* a, const T* b, const size_t n) { simd::multiply(dst, a, b, n); }
+        template <typename T>
+        static void scalarKernel(T* dst, const T* a, const T s, const size_t n) { simd::scale(dst, a, s, n); }
+    };
+
+    //Leaves expose contiguousData() so simple expressions can still run on the SIMD kernels
+    template <typename M>
+    class Ref : public Node<Ref<M>>
+    {
+    private:
+        const M& m_matrix;
+
+    public:
+        using value_type = typename M::value_type;
+        static constexpr bool is_leaf{ true };
+
+        explicit Ref(const M& matrix) : m_matrix{ matrix } {}
+
+        size_t nRow() const { return m_matrix.nRow(); }
+        size_t nCol() const { return m_matrix.nCol(); }
+        value_type operator()(const size_t row_idx, const size_t col_idx) const { return m_matrix(row_idx, col_idx); }
+        const value_type* contiguousData() const { return m_matrix.data(); }
+        M* ownedStorage() { return nullptr; }
+        bool reads(const value_type* first, const value_type* last) const { return intersects(m_matrix.data(), m_matrix.data() + m_matrix.size(), first, last); }
+        //A leaf starting at the destination has its shape and is only read at the element being written
+        bool overlaps(const value_type* first, const value_type* last) const { return m_matrix.data() != first && reads(first, last); }
+    };
+
+    template <typename M>
+    class Owned : public Node<Owned<M>>
+    {
+    private:
+        M m_matrix;
+
+    public:
+        using value_type = typename M::value_type;
+        static constexpr bool is_leaf{ true };
+
+        explicit Owned(M&& matrix) : m_matrix{ std::move(matrix) } {}
+
+        size_t nRow() const { return m_matrix.nRow(); }
+        size_t nCol() const { return m_matrix.nCol(); }
+        value_type operator()(const size_t row_idx, const size_t col_idx) const { return m_matrix(row_idx, col_idx); }
+        const value_type* contiguousData() const { return m_matrix.data(); }
+        M* ownedStorage() { return &m_matrix; }
+        bool reads(const value_type* first, const value_type* last) const { return intersects(m_matrix.data(), m_matrix.data() + m_matrix.size(), first, last); }
+        bool overlaps(const value_type* first, const value_type* last) const { return m_matrix.data() != first && reads(first, last); }
+    };
+
+    template <typename T>
+    class ViewLeaf : public Node<ViewLeaf<T>>
+    {
+    private:
+        BasicMatrixView<T> m_view;
+
+    public:
+        using value_type = T;
+        static constexpr bool is_leaf{ true };
+
+        explicit ViewLeaf(const BasicMatrixView<T>& view) : m_view{ view } {}
+
+        size_t nRow() const { return m_view.nRow(); }
+        size_t nCol() const { return m_view.nCol(); }
+        T operator()(const size_t row_idx, const size_t col_idx) const { return m_view(row_idx, col_idx); }
+        const T* contiguousData() const { return m_view.isContiguous() ? m_view.data() : nullptr; }
+        BasicMatrix<T>* ownedStorage() { return nullptr; }
+        bool reads(const T* first, const T* last) const { return m_view.overlaps(first, last); }
+        bool overlaps(const T* first, const T* last) const { return !(m_view.isContiguous() && m_view.data() == first) && reads(first, last); }
+    };
+
+    template <Operand T>
+    auto leaf(T&& operand)
+    {
+        using Plain = std::remove_cvref_t<T>;
+        if constexpr (IsNode<Plain>)
+            return Plain{ std::forward<T>(operand) };
+        else if constexpr (IsViewType<Plain>::value)
+            return ViewLeaf<typename Plain::value_type>{ operand };
+        else if constexpr (std::is_lvalue_reference_v<T>)
+            return Ref<Plain>{ operand };
+        else
+            return Owned<Plain>{ std::move(operand) };
+    }
+
+    template <typename T>
+    using LeafType = decltype(leaf(std::declval<T>()));
+
+    //Element-wise combination of two operands of the same shape
+    template <typename Op, typename L, typename R>
+    class Binary : public Node<Binary<Op, L, R>>
+    {
+    private:
+        L m_left;
+        R m_right;
+
+    public:
+        using value_type = typename L::value_type;
+        static_assert(std::is_same_v<value_type, typename R::value_type>, "Operands have different scalar types!");
+        static constexpr bool is_leaf{ false };
+
+        Binary(L left, R right) : m_left{ std::move(left) }, m_right{ std::move(right) }
+        {
+            if (m_left.nRow() != m_right.nRow() || m_left.nCol() != m_right.nCol())
+                throw std::invalid_argument("Matrices have different dimensions!");
+        }
+
+        size_t nRow() const { return m_left.nRow(); }
+        size_t nCol() const { return m_left.nCol(); }
+        value_type operator()(const size_t row_idx, const size_t col_idx) const { return Op::apply(m_left(row_idx, col_idx), m_right(row_idx, col_idx)); }
+        bool reads(const value_type* first, const value_type* last) const { return m_left.reads(first, last) || m_right.reads(first, last); }
+        bool overlaps(const value_type* first, const value_type* last) const { return m_left.overlaps(first, last) || m_right.overlaps(first, last); }
+
+        auto* ownedStorage()
+        {
+            auto* storage{ m_left.ownedStorage() };
+            return storage ? storage : m_right.ownedStorage();
+        }
+
+        bool tryKernel(value_type* dst, const size_t first, const size_t last) const
+        {
+            if constexpr (L::is_leaf && R::is_leaf)
+            {
+                if (m_left.contiguousData() && m_right.contiguousData())
+                {
+                    Op::kernel(dst + first, m_left.contiguousData() + first, m_right.contiguousData() + first, last - first);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    //Combines every column of the left operand with a single column vector
+    template <typename Op, typename L, typename R>
+    class Columnwise : public Node<Columnwise<Op, L, R>>
+    {
+    private:
+        L m_left;
+        R m_right;
+
+    public:
+        using value_type = typename L::value_type;
+        static_assert(std::is_same_v<value_type, typename R::value_type>, "Operands have different scalar types!");
+        static constexpr bool is_leaf{ false };
+
+        Columnwise(L left, R right) : m_left{ std::move(left) }, m_right{ std::move(right) }
+        {
+            if (m_left.nRow() != m_right.nRow() || m_right.nCol() != 1)
+                throw std::invalid_argument("Matrices have different dimensions!");
+        }
+
+        size_t nRow() const { return m_left.nRow(); }
+        size_t nCol() const { return m_left.nCol(); }
+        value_type operator()(const size_t row_idx, const size_t col_idx) const { return Op::apply(m_left(row_idx, col_idx), m_right(row_idx, 0)); }
+        bool reads(const value_type* first, const value_type* last) const { return m_left.reads(first, last) || m_right.reads(first, last); }
+        //Unless it is a single column, the destination has a different shape than the column vector
+        bool overlaps(const value_type* first, const value_type* last) const
+        {
+            return m_left.overlaps(first, last) || (nCol() == 1 ? m_right.overlaps(first, last) : m_right.reads(first, last));
+        }
+
+        auto* ownedStorage() { return m_left.ownedStorage(); }
+
+        bool tryKernel(value_type* dst, const size_t first, const size_t last) const
+        {
+            if constexpr (L::is_leaf)
+            {
+                const value_type* left{ m_left.contiguousData() };
+                if (left)
+                {
+                    //One kernel call per row, or per part of a row at the ends of the range
+                    size_t ncol{ nCol() };
+                    for (size_t idx{ first }; idx < last;)
+                    {
+                        size_t row_idx{ idx / ncol };
+                        size_t row_last{ std::min(last, (row_idx + 1) * ncol) };
+                        Op::scalarKernel(dst + idx, left + idx, m_right(row_idx, 0), row_last - idx);
+                        idx = row_last;
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    //Combines every element with a scalar on the right
+    template <typename Op, typename L>
+    class Scalar : public Node<Scalar<Op, L>>
+    {
+    private:
+        L m_left;
+        typename L::value_type m_scalar;
+
+    public:
+        using value_type = typename L::value_type;
+        static constexpr bool is_leaf{ false };
+
+        Scalar(L left, const value_type scalar) : m_left{ std::move(left) }, m_scalar{ scalar } {}
+
+        size_t nRow() const { return m_left.nRow(); }
+        size_t nCol() const { return m_left.nCol(); }
+        value_type operator()(const size_t row_idx, const size_t col_idx) const { return Op::apply(m_left(row_idx, col_idx), m_scalar); }
+        bool reads(const value_type* first, const value_type* last) const { return m_left.reads(first, last); }
+        bool overlaps(const value_type* first, const value_type* last) const { return m_left.overlaps(first, last); }
+        auto* ownedStorage() { return m_left.ownedStorage(); }
+
+        bool tryKernel(value_type* dst, const size_t first, const size_t last) const
+        {
+            if constexpr (L::is_leaf)
+            {
+                if (m_left.contiguousData())
+                {
+                    Op::scalarKernel(dst + first, m_left.contiguousData() + first, m_scalar, last - first);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    template <typename Op, Operand L, Operand R>
+    auto binary(L&& left, R&& right)
+    {
+        return Binary<Op, LeafType<L>, LeafType<R>>{ leaf(std::forward<L>(left)), leaf(std::forward<R>(right)) };
+    }
+
+    template <typename Op, Operand L, Operand R>
+    auto columnwise(L&& left, R&& right)
+    {
+        return Columnwise<Op, LeafType<L>, LeafType<R>>{ leaf(std::forward<L>(left)), leaf(std::forward<R>(right)) };
+    }
+
+    //The scalar is converted to the operand's precision
+    template <typename Op, Operand L>
+    auto scalar(L&& left, const double value)
+    {
+        using Leaf = LeafType<L>;
+        return Scalar<Op, Leaf>{ leaf(std::forward<L>(left)), static_cast<typename Leaf::value_type>(value) };
+    }
+
+    //Element-wise loops are split across threads in chunks of at least this many elements
+    constexpr size_t PARALLEL_ELEMENTS{ 1 << 15 };
+
+    //Writes elements [first, last) of the expression, counted row-major, into storage of the same shape
+    template <typename E>
+    void evaluateRange(const E& expression, typename E::value_type* dst, const size_t first, const size_t last)
+    {
+        if constexpr (!E::is_leaf)
+        {
+            if (expression.tryKernel(dst, first, last))
+                return;
+        }
+
+        size_t ncol{ expression.nCol() };
+        for (size_t idx{ first }; idx < last;)
+        {
+            size_t row_idx{ idx / ncol };
+            size_t row_last{ std::min(last, (row_idx + 1) * ncol) };
+            for (size_t col_idx{ idx - row_idx * ncol }; idx < row_last; idx++, col_idx++)
+            {
+                dst[idx] = expression(row_idx, col_idx);
+            }
+        }
+    }
+
+    //Writes the expression into row-major storage of the same shape.
+    //Large expressions are evaluated by several threads; since the destination never overlaps the operands other
+    //than element for element, every element is still computed from unmodified inputs.
+    template <typename E>
+    void evaluate(const E& expression, typename E::value_type* dst)
+    {
+        parallel::forRange(expression.nRow() * expression.nCol(), PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+            {
+                evaluateRange(expression, dst, first, last);
+            });
+    }
+
+    //Applies dst op= expression element by element
+    template <typename Op, typename E>
+    void evaluateCompound(const E& expression, typename E::value_type* dst)
+    {
+        size_t ncol{ expression.nCol() };
+        parallel::forRange(expression.nRow() * ncol, PARALLEL_ELEMENTS, [&](const size_t first, const size_t last)
+            {
+                for (size_t idx{ first }; idx < last;)
+                {
+                    size_t row_idx{ idx / ncol };
+                    size_t row_last{ std::min(last, (row_idx + 1) * ncol) };
+                    for (size_t col_idx{ idx - row_idx * ncol }; idx < row_last; idx++, col_idx++)
+                    {
+                        dst[idx] = Op::apply(dst[idx], expression(row_idx, col_idx));
+                    }
+                }
+            });
+    }
+
+    template <typename L, typename R>
+    typename L::value_type dotProduct(const L& left, const R& right)
+    {
+        if (left.nRow() != right.nRow() || left.nCol() != right.nCol())
+            throw std::invalid_argument("Matrices have different dimensions!");
+
+        if constexpr (L::is_leaf && R::is_leaf)
+        {
+            if (left.contiguousData() && right.contiguousData())
+                return simd::dot(left.contiguousData(), right.contiguousData(), left.nRow() * left.nCol());
+        }
+
+        //Row-major sequential order, the same as reducing the evaluated matrices
+        typename L::value_type result{ 0 };
+        for (size_t i{ 0 }; i < left.nRow(); i++)
+        {
+            for (size_t j{ 0 }; j < left.nCol(); j++)
+            {
+                result += left(i, j) * right(i, j);
+            }
+        }
+        return result;
+    }
+
+    template <typename E>
+    typename E::value_type sumElements(const E& expression)
+    {
+        if constexpr (E::is_leaf)
+        {
+            if (expression.contiguousData())
+                return simd::sum(expression.contiguousData(), expression.nRow() * expression.nCol());
+        }
+
+        typename E::value_type result{ 0 };
+        for (size_t i{ 0 }; i < expression.nRow(); i++)
+        {
+            for (size_t j{ 0 }; j < expression.nCol(); j++)
+            {
+                result += expression(i, j);
+            }
+        }
+        return result;
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::hadamardProduct(R&& other_matrix) const&
+    {
+        return binary<Multiply>(derived(), std::forward<R>(other_matrix));
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::hadamardProduct(R&& other_matrix) &&
+    {
+        return binary<Multiply>(moved(), std::forward<R>(other_matrix));
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::hadamardProductColumnwise(R&& other_matrix) const&
+    {
+        return columnwise<Multiply>(derived(), std::forward<R>(other_matrix));
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::hadamardProductColumnwise(R&& other_matrix) &&
+    {
+        return columnwise<Multiply>(moved(), std::forward<R>(other_matrix));
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::addColumnwise(R&& other_matrix) const&
+    {
+        return columnwise<Add>(derived(), std::forward<R>(other_matrix));
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::addColumnwise(R&& other_matrix) &&
+    {
+        return columnwise<Add>(moved(), std::forward<R>(other_matrix));
+    }
+
+    template <typename Derived>
+    template <Operand R>
+    auto Node<Derived>::dotProduct(R&& other_matrix) const
+    {
+        return expr::dotProduct(derived(), leaf(std::forward<R>(other_matrix)));
+    }
+
+    template <typename Derived>
+    auto Node<Derived>::sumElements() const
+    {
+        return expr::sumElements(derived());
+    }
+}
+
+template <expr::Operand L, expr::Operand R>
+auto operator+(L&& left, R&& right)
+{
+    return expr::binary<expr::Add>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <expr::Operand L, expr::Operand R>
+auto operator-(L&& left, R&& right)
+{
+    return expr::binary<expr::Subtract>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <expr::Operand L>
+auto operator+(L&& left, const double add_me)
+{
+    return expr::scalar<expr::Add>(std::forward<L>(left), add_me);
+}
+
+template <expr::Operand L>
+auto operator-(L&& left, const double subtract_me)
+{
+    return expr::scalar<expr::Subtract>(std::forward<L>(left), subtract_me);
+}
+
+template <expr::Operand L>
+auto operator*(L&& left, const double multiplier)
+{
+    return expr::scalar<expr::Multiply>(std::forward<L>(left), multiplier);
+}
\ No newline at end of file
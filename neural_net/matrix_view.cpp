@@ -0,0 +1,219 @@
+#include "matrix_view.h"
+#include "matrix.h"
+#include "simd.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+template <typename T>
+BasicMatrixView<T>::BasicMatrixView(const T* data, const size_t nrow, const size_t ncol, const size_t row_stride, const size_t col_stride,
+    const size_t* row_idx, const size_t* col_idx)
+    : m_data{ data }, m_nrow{ nrow }, m_ncol{ ncol }, m_row_stride{ row_stride }, m_col_stride{ col_stride }, m_row_idx{ row_idx }, m_col_idx{ col_idx }
+{
+    if ((nrow == 0 && ncol > 0) || (nrow > 0 && ncol == 0))
+        throw std::invalid_argument("One dimension is zero while the other one is not!");
+}
+
+template <typename T>
+BasicMatrixView<T>::BasicMatrixView(const BasicMatrix<T>& matrix)
+    : m_data{ matrix.data() }, m_nrow{ matrix.nRow() }, m_ncol{ matrix.nCol() }, m_row_stride{ matrix.nCol() }, m_col_stride{ 1 }
+{
+}
+
+template <typename T>
+size_t BasicMatrixView<T>::size() const
+{
+    return m_nrow * m_ncol;
+}
+
+template <typename T>
+size_t BasicMatrixView<T>::nRow() const
+{
+    return m_nrow;
+}
+
+template <typename T>
+size_t BasicMatrixView<T>::nCol() const
+{
+    return m_ncol;
+}
+
+template <typename T>
+size_t BasicMatrixView<T>::rowStride() const
+{
+    return m_row_stride;
+}
+
+template <typename T>
+size_t BasicMatrixView<T>::colStride() const
+{
+    return m_col_stride;
+}
+
+template <typename T>
+const T* BasicMatrixView<T>::data() const
+{
+    return m_data;
+}
+
+template <typename T>
+bool BasicMatrixView<T>::hasIndirection() const
+{
+    return m_row_idx != nullptr || m_col_idx != nullptr;
+}
+
+template <typename T>
+bool BasicMatrixView<T>::isContiguous() const
+{
+    return !hasIndirection() && m_col_stride == 1 && (m_row_stride == m_ncol || m_nrow <= 1);
+}
+
+template <typename T>
+bool BasicMatrixView<T>::overlaps(const T* first, const T* last) const
+{
+    if (size() == 0 || first == last)
+        return false;
+
+    size_t max_row{ m_row_idx ? *std::max_element(m_row_idx, m_row_idx + m_nrow) : m_nrow - 1 };
+    size_t max_col{ m_col_idx ? *std::max_element(m_col_idx, m_col_idx + m_ncol) : m_ncol - 1 };
+    const T* end{ m_data + max_row * m_row_stride + max_col * m_col_stride + 1 };
+
+    std::less<const T*> less{};
+    return less(m_data, last) && less(first, end);
+}
+
+template <typename T>
+T BasicMatrixView<T>::sumElements() const
+{
+    if (isContiguous())
+        return simd::sum(m_data, size());
+
+    //Same row-major order as summing the materialized matrix
+    T result{ 0 };
+    for (size_t i{ 0 }; i < m_nrow; i++)
+    {
+        const T* row{ m_data + rowOffset(i) };
+        for (size_t j{ 0 }; j < m_ncol; j++)
+        {
+            result += row[colOffset(j)];
+        }
+    }
+    return result;
+}
+
+template <typename T>
+T BasicMatrixView<T>::dotProduct(const BasicMatrixView& other_view) const
+{
+    if (m_ncol != other_view.m_ncol || m_nrow != other_view.m_nrow)
+        throw std::invalid_argument("Matrices have different dimensions!");
+
+    if (isContiguous() && other_view.isContiguous())
+        return simd::dot(m_data, other_view.m_data, size());
+
+    T result{ 0 };
+    for (size_t i{ 0 }; i < m_nrow; i++)
+    {
+        for (size_t j{ 0 }; j < m_ncol; j++)
+        {
+            result += (*this)(i, j) * other_view(i, j);
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::row(const size_t row_idx) const
+{
+    if (row_idx >= m_nrow)
+        throw std::invalid_argument("Index exceeds dimensions!");
+
+    return BasicMatrixView{ m_data + rowOffset(row_idx), 1, m_ncol, m_row_stride, m_col_stride, nullptr, m_col_idx };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::rows(const size_t first_row, const size_t count) const
+{
+    if (first_row + count > m_nrow || count == 0)
+        throw std::invalid_argument("Index exceeds dimensions!");
+
+    if (m_row_idx)
+        return BasicMatrixView{ m_data, count, m_ncol, m_row_stride, m_col_stride, m_row_idx + first_row, m_col_idx };
+
+    return BasicMatrixView{ m_data + first_row * m_row_stride, count, m_ncol, m_row_stride, m_col_stride, nullptr, m_col_idx };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::rowsAt(const size_t* row_idx, const size_t count) const
+{
+    if (m_row_idx)
+        throw std::invalid_argument("View already has a row indirection!");
+    if (count == 0)
+        throw std::invalid_argument("No rows selected!");
+    if (*std::max_element(row_idx, row_idx + count) >= m_nrow)
+        throw std::invalid_argument("Index exceeds dimensions!");
+
+    return BasicMatrixView{ m_data, count, m_ncol, m_row_stride, m_col_stride, row_idx, m_col_idx };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::rows(const std::vector<size_t>& row_idx) const
+{
+    return rowsAt(row_idx.data(), row_idx.size());
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::col(const size_t col_idx) const
+{
+    if (col_idx >= m_ncol)
+        throw std::invalid_argument("Index exceeds dimensions!");
+
+    return BasicMatrixView{ m_data + colOffset(col_idx), m_nrow, 1, m_row_stride, m_col_stride, m_row_idx, nullptr };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::cols(const size_t first_col, const size_t count) const
+{
+    if (first_col + count > m_ncol || count == 0)
+        throw std::invalid_argument("Index exceeds dimensions!");
+
+    if (m_col_idx)
+        return BasicMatrixView{ m_data, m_nrow, count, m_row_stride, m_col_stride, m_row_idx, m_col_idx + first_col };
+
+    return BasicMatrixView{ m_data + first_col * m_col_stride, m_nrow, count, m_row_stride, m_col_stride, m_row_idx, nullptr };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::cols(const std::vector<size_t>& col_idx) const
+{
+    if (m_col_idx)
+        throw std::invalid_argument("View already has a column indirection!");
+    if (col_idx.empty())
+        throw std::invalid_argument("No columns selected!");
+    if (*std::max_element(col_idx.begin(), col_idx.end()) >= m_ncol)
+        throw std::invalid_argument("Index exceeds dimensions!");
+
+    return BasicMatrixView{ m_data, m_nrow, col_idx.size(), m_row_stride, m_col_stride, m_row_idx, col_idx.data() };
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::transpose() const
+{
+    return BasicMatrixView{ m_data, m_ncol, m_nrow, m_col_stride, m_row_stride, m_col_idx, m_row_idx };
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixView<T>::materialize() const
+{
+    std::vector<T> result(size());
+    for (size_t i{ 0 }; i < m_nrow; i++)
+    {
+        for (size_t j{ 0 }; j < m_ncol; j++)
+        {
+            result[i * m_ncol + j] = (*this)(i, j);
+        }
+    }
+    return BasicMatrix<T>{ m_nrow, m_ncol, std::move(result) };
+}
+
+template class BasicMatrixView<float>;
+template class BasicMatrixView<double>;
\ No newline at end of file
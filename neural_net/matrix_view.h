@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class BasicMatrix;
+
+//Non-owning, read-only window onto matrix storage.
+//Element (i, j) lives at data[rowOffset(i) + colOffset(j)], where each offset is the stride times either the
+//logical index or, when an index indirection is set for that dimension, the index looked up in it.
+//A view never outlives the storage or index vector it was built from.
+template <typename T>
+class BasicMatrixView
+{
+private:
+    const T* m_data{};
+    size_t m_nrow{};
+    size_t m_ncol{};
+    size_t m_row_stride{};
+    size_t m_col_stride{};
+    const size_t* m_row_idx{};
+    const size_t* m_col_idx{};
+
+public:
+    using value_type = T;
+
+    explicit BasicMatrixView(const T* data = nullptr, const size_t nrow = 0, const size_t ncol = 0, const size_t row_stride = 0, const size_t col_stride = 1,
+        const size_t* row_idx = nullptr, const size_t* col_idx = nullptr);
+    BasicMatrixView(const BasicMatrix<T>& matrix);
+
+    size_t size() const;
+    size_t nRow() const;
+    size_t nCol() const;
+    size_t rowStride() const;
+    size_t colStride() const;
+    const T* data() const;
+    bool hasIndirection() const;
+    bool isContiguous() const;
+    bool overlaps(const T* first, const T* last) const;
+    T sumElements() const;
+    T dotProduct(const BasicMatrixView& other_view) const;
+    BasicMatrixView row(const size_t row_idx) const;
+    BasicMatrixView rows(const size_t first_row, const size_t count) const;
+    //Selects rows through an index array that must outlive the view; named apart from rows(first_row, count) so a
+    //literal 0 can't be read as a null index pointer
+    BasicMatrixView rowsAt(const size_t* row_idx, const size_t count) const;
+    //The view keeps a pointer into the index vector, so temporaries are rejected
+    BasicMatrixView rows(const std::vector<size_t>& row_idx) const;
+    BasicMatrixView rows(std::vector<size_t>&& row_idx) const = delete;
+    BasicMatrixView col(const size_t col_idx) const;
+    BasicMatrixView cols(const size_t first_col, const size_t count) const;
+    BasicMatrixView cols(const std::vector<size_t>& col_idx) const;
+    BasicMatrixView cols(std::vector<size_t>&& col_idx) const = delete;
+    BasicMatrixView transpose() const;
+    BasicMatrix<T> materialize() const;
+
+    size_t rowOffset(const size_t row_idx) const
+    {
+        return (m_row_idx ? m_row_idx[row_idx] : row_idx) * m_row_stride;
+    }
+
+    size_t colOffset(const size_t col_idx) const
+    {
+        return (m_col_idx ? m_col_idx[col_idx] : col_idx) * m_col_stride;
+    }
+
+    const T& operator()(const size_t row_idx, const size_t col_idx) const
+    {
+        return m_data[rowOffset(row_idx) + colOffset(col_idx)];
+    }
+
+    //Hidden friend, so a Matrix on either side converts to a view
+    friend BasicMatrix<T> operator*(const BasicMatrixView& left_view, const BasicMatrixView& right_view)
+    {
+        BasicMatrix<T> result{};
+        multiplyInto(left_view, right_view, result);
+        return result;
+    }
+};
+
+using MatrixView = BasicMatrixView<double>;
+using FloatMatrixView = BasicMatrixView<float>;
\ No newline at end of file
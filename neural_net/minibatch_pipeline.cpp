@@ -0,0 +1,198 @@
+#include "minibatch_pipeline.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    //Rows gathered together, so the source rows stay in cache while each of their columns is written out
+    constexpr size_t GATHER_TILE{ 16 };
+
+    //Writes the rows of source picked by row_idx into result as columns
+    template <typename T>
+    void gatherTransposed(const BasicMatrix<T>& source, const size_t* row_idx, const size_t count, BasicMatrix<T>& result)
+    {
+        size_t n_cols{ source.nCol() };
+        result.resize(n_cols, count);
+        const T* source_data{ source.data() };
+        T* result_data{ result.data() };
+
+        for (size_t first{ 0 }; first < count; first += GATHER_TILE)
+        {
+            size_t last{ std::min(first + GATHER_TILE, count) };
+            for (size_t col{ 0 }; col < n_cols; col++)
+            {
+                T* result_row{ result_data + col * count };
+                for (size_t j{ first }; j < last; j++)
+                {
+                    result_row[j] = source_data[row_idx[j] * n_cols + col];
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+BasicMinibatchPipeline<T>::BasicMinibatchPipeline(const size_t depth)
+    : m_slots(depth)
+{
+    if (depth == 0)
+        throw std::invalid_argument("Pipeline needs at least one slot!");
+}
+
+template <typename T>
+BasicMinibatchPipeline<T>::~BasicMinibatchPipeline()
+{
+    stop();
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_exit = true;
+    }
+    m_pass_cv.notify_one();
+    if (m_producer.joinable())
+        m_producer.join();
+}
+
+template <typename T>
+void BasicMinibatchPipeline<T>::start(const BasicMatrix<T>& y, const BasicMatrix<T>& x, const std::vector<size_t>& row_order, const size_t batch_size)
+{
+    if (batch_size == 0)
+        throw std::invalid_argument("Batch size must be positive!");
+    if (y.nRow() != x.nRow())
+        throw std::invalid_argument("Matrices have different numbers of rows!");
+
+    stop();
+    m_y = &y;
+    m_x = &x;
+    m_row_order = &row_order;
+    m_batch_size = batch_size;
+    m_n_batches = (row_order.size() + batch_size - 1) / batch_size;
+    m_background = parallel::numThreads() > 1;
+    if (!m_background)
+        return;
+
+    if (!m_producer.joinable())
+        m_producer = std::thread{ &BasicMinibatchPipeline::producerLoop, this };
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_n_passes++;
+        m_producing = true;
+    }
+    m_pass_cv.notify_one();
+}
+
+template <typename T>
+void BasicMinibatchPipeline<T>::gather(const size_t batch_idx)
+{
+    size_t first_row{ batch_idx * m_batch_size };
+    size_t n_batch_rows{ std::min(m_batch_size, m_row_order->size() - first_row) };
+    Batch& batch{ m_slots[batch_idx % m_slots.size()] };
+    gatherTransposed(*m_x, m_row_order->data() + first_row, n_batch_rows, batch.x_t);
+    gatherTransposed(*m_y, m_row_order->data() + first_row, n_batch_rows, batch.y_t);
+}
+
+template <typename T>
+void BasicMinibatchPipeline<T>::producerLoop()
+{
+    size_t n_passes_seen{ 0 };
+    std::unique_lock<std::mutex> lock{ m_mutex };
+    for (;;)
+    {
+        m_pass_cv.wait(lock, [&] { return m_exit || m_n_passes != n_passes_seen; });
+        if (m_exit)
+            return;
+        n_passes_seen = m_n_passes;
+
+        lock.unlock();
+        producePass();
+        lock.lock();
+        m_producing = false;
+        m_produced_cv.notify_one();
+    }
+}
+
+template <typename T>
+void BasicMinibatchPipeline<T>::producePass()
+{
+    try
+    {
+        for (size_t i{ 0 }; i < m_n_batches; i++)
+        {
+            //The slot of batch i is free once the consumer has released the batch depth places before it
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_consumed_cv.wait(lock, [&] { return m_stop || i < m_n_consumed + m_slots.size(); });
+                if (m_stop)
+                    return;
+            }
+
+            gather(i);
+
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_n_produced = i + 1;
+            }
+            m_produced_cv.notify_one();
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_error = std::current_exception();
+        }
+        m_produced_cv.notify_one();
+    }
+}
+
+template <typename T>
+const typename BasicMinibatchPipeline<T>::Batch& BasicMinibatchPipeline<T>::next()
+{
+    std::unique_lock<std::mutex> lock{ m_mutex };
+    if (m_holding)
+    {
+        m_n_consumed++;
+        m_holding = false;
+        m_consumed_cv.notify_one();
+    }
+    if (m_n_consumed >= m_n_batches)
+        throw std::invalid_argument("No minibatches left in this pass!");
+
+    if (!m_background)
+    {
+        gather(m_n_consumed);
+        m_holding = true;
+        return m_slots[m_n_consumed % m_slots.size()];
+    }
+
+    m_produced_cv.wait(lock, [&] { return m_error || m_n_produced > m_n_consumed; });
+    if (m_n_produced <= m_n_consumed)
+        std::rethrow_exception(m_error);
+
+    m_holding = true;
+    return m_slots[m_n_consumed % m_slots.size()];
+}
+
+template <typename T>
+void BasicMinibatchPipeline<T>::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_stop = true;
+        m_consumed_cv.notify_one();
+        m_produced_cv.wait(lock, [&] { return !m_producing; });
+    }
+
+    m_y = nullptr;
+    m_x = nullptr;
+    m_row_order = nullptr;
+    m_n_batches = 0;
+    m_n_produced = 0;
+    m_n_consumed = 0;
+    m_holding = false;
+    m_stop = false;
+    m_error = nullptr;
+}
+
+template class BasicMinibatchPipeline<float>;
+template class BasicMinibatchPipeline<double>;
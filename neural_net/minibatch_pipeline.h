@@ -0,0 +1,73 @@
+#pragma once
+#include "matrix.h"
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Assembles the minibatches of a training pass on a background thread while the caller trains on earlier ones.
+//Each minibatch is gathered through the shuffled row order into a ring slot as contiguous, already-transposed
+//matrices: one column per row of the batch, as backpropagation consumes them. The slots keep their allocations
+//from pass to pass, so after the first full batch nothing is allocated. The producer thread is started by the first
+//pass that needs it and then waits between passes until the pipeline is destroyed. When the caller may use only one
+//thread (parallel::numThreads() under any ThreadLimit at start()), there is nothing to overlap with, so each
+//minibatch is gathered when it is asked for instead.
+template <typename T>
+class BasicMinibatchPipeline
+{
+public:
+    static constexpr size_t DEFAULT_DEPTH{ 2 };
+
+    struct Batch
+    {
+        BasicMatrix<T> y_t{};
+        BasicMatrix<T> x_t{};
+    };
+
+private:
+    std::vector<Batch> m_slots{};
+    bool m_background{};
+    const BasicMatrix<T>* m_y{};
+    const BasicMatrix<T>* m_x{};
+    const std::vector<size_t>* m_row_order{};
+    size_t m_batch_size{};
+    std::thread m_producer{};
+    std::mutex m_mutex{};
+    std::condition_variable m_pass_cv{};
+    std::condition_variable m_produced_cv{};
+    std::condition_variable m_consumed_cv{};
+    size_t m_n_passes{};
+    bool m_producing{};
+    bool m_exit{};
+    size_t m_n_batches{};
+    size_t m_n_produced{};
+    size_t m_n_consumed{};
+    bool m_holding{};
+    bool m_stop{};
+    std::exception_ptr m_error{};
+
+    void gather(const size_t batch_idx);
+    void producerLoop();
+    void producePass();
+
+public:
+    //depth is the number of ring slots; 2 double-buffers, more lets the producer run further ahead
+    explicit BasicMinibatchPipeline(const size_t depth = DEFAULT_DEPTH);
+    ~BasicMinibatchPipeline();
+    BasicMinibatchPipeline(const BasicMinibatchPipeline&) = delete;
+    BasicMinibatchPipeline& operator=(const BasicMinibatchPipeline&) = delete;
+
+    //Starts a pass over the rows of x and y in row_order, batch_size rows per minibatch, stopping any pass still
+    //running. The arguments must stay alive and unchanged until the pass is stopped or the pipeline destroyed.
+    void start(const BasicMatrix<T>& y, const BasicMatrix<T>& x, const std::vector<size_t>& row_order, const size_t batch_size);
+    //Waits for the next minibatch of the pass and hands it out; the one returned by the previous call goes back to
+    //the producer. Rethrows an exception thrown while gathering.
+    const Batch& next();
+    //Ends the current pass, waiting for the producer to finish the minibatch it is gathering
+    void stop();
+};
+
+using MinibatchPipeline = BasicMinibatchPipeline<double>;
+using FloatMinibatchPipeline = BasicMinibatchPipeline<float>;
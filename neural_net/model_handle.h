@@ -0,0 +1,183 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+//Shared access to the current version of a model that a background thread can replace while others read it.
+//Readers pin the current version with a hazard pointer: read() claims one of READER_SLOTS slots with a single
+//compare-exchange, publishes the pointer it is about to use there and returns a guard; it never waits for a writer.
+//publish() swaps the new version in atomically and retires the old one, so a reader sees either the whole old model or
+//the whole new one. A retired version is deleted by publish() if no slot holds it, otherwise by the last Reader
+//pinning it as it goes out of scope, which then briefly takes the writer lock. Each thread reuses the slot it had last time,
+//keeping the read side on a cache line no other thread writes in the common case.
+//Writers are serialized among themselves. Holding more than READER_SLOTS guards at once makes further read() calls
+//spin until one is released.
+template <typename Model>
+class ModelHandle
+{
+public:
+    static constexpr size_t READER_SLOTS{ 128 };
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<const Model*> model{};
+    };
+
+    std::atomic<const Model*> m_current{};
+    mutable std::array<Slot, READER_SLOTS> m_slots{};
+    //Mutable so a const handle's Readers can delete the version they were the last to pin
+    mutable std::mutex m_writer_mutex{};
+    mutable std::vector<const Model*> m_retired{};
+    //Size of m_retired, so releasing a Reader skips the lock while nothing waits to be deleted
+    mutable std::atomic<size_t> m_n_retired{};
+
+    bool isPinned(const Model* model) const
+    {
+        for (const Slot& slot : m_slots)
+        {
+            if (slot.model.load(std::memory_order_seq_cst) == model)
+                return true;
+        }
+        return false;
+    }
+
+    size_t reclaimLocked() const
+    {
+        std::erase_if(m_retired, [&](const Model* model) {
+            if (isPinned(model))
+                return false;
+            delete model;
+            return true;
+        });
+        m_n_retired.store(m_retired.size(), std::memory_order_seq_cst);
+        return m_retired.size();
+    }
+
+public:
+    //Keeps the version it pinned alive until it goes out of scope
+    class Reader
+    {
+    private:
+        const ModelHandle* m_handle{};
+        const Model* m_model{};
+        std::atomic<const Model*>* m_slot{};
+
+        Reader(const ModelHandle* handle, const Model* model, std::atomic<const Model*>* slot)
+            : m_handle{ handle }, m_model{ model }, m_slot{ slot }
+        {
+        }
+
+        friend class ModelHandle;
+
+    public:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        ~Reader()
+        {
+            m_slot->store(nullptr, std::memory_order_seq_cst);
+            //A version that is no longer current was retired while pinned, and this may have been its last reader
+            if (m_handle->m_n_retired.load(std::memory_order_seq_cst) != 0 && m_model != m_handle->m_current.load(std::memory_order_seq_cst))
+            {
+                std::lock_guard<std::mutex> lock{ m_handle->m_writer_mutex };
+                m_handle->reclaimLocked();
+            }
+        }
+
+        const Model& operator*() const
+        {
+            return *m_model;
+        }
+
+        const Model* operator->() const
+        {
+            return m_model;
+        }
+    };
+
+    explicit ModelHandle(std::unique_ptr<const Model> model)
+    {
+        if (!model)
+            throw std::invalid_argument("Model handle needs a model!");
+        m_current.store(model.release(), std::memory_order_release);
+    }
+
+    //No Reader may outlive the handle
+    ~ModelHandle()
+    {
+        for (const Model* model : m_retired)
+        {
+            delete model;
+        }
+        delete m_current.load(std::memory_order_acquire);
+    }
+
+    ModelHandle(const ModelHandle&) = delete;
+    ModelHandle& operator=(const ModelHandle&) = delete;
+
+    Reader read() const
+    {
+        thread_local size_t slot_hint{ std::hash<std::thread::id>{}(std::this_thread::get_id()) % READER_SLOTS };
+        const Model* model{ m_current.load(std::memory_order_seq_cst) };
+        for (size_t attempt{ 0 };; attempt++)
+        {
+            size_t idx{ (slot_hint + attempt) % READER_SLOTS };
+            const Model* expected{ nullptr };
+            if (!m_slots[idx].model.compare_exchange_strong(expected, model, std::memory_order_seq_cst))
+            {
+                //Every slot was taken on this pass
+                if (attempt % READER_SLOTS == READER_SLOTS - 1)
+                    std::this_thread::yield();
+                continue;
+            }
+
+            //The version may have been retired, and its retired list scanned, before the slot was set; a pointer
+            //still current after the slot is visible can't be deleted until the slot clears
+            const Model* current{ m_current.load(std::memory_order_seq_cst) };
+            while (current != model)
+            {
+                model = current;
+                m_slots[idx].model.store(model, std::memory_order_seq_cst);
+                current = m_current.load(std::memory_order_seq_cst);
+            }
+            slot_hint = idx;
+            return Reader{ this, model, &m_slots[idx].model };
+        }
+    }
+
+    //Makes model the current version; the previous one is deleted here or by the last Reader holding it
+    void publish(std::unique_ptr<const Model> model)
+    {
+        if (!model)
+            throw std::invalid_argument("Model handle needs a model!");
+
+        std::lock_guard<std::mutex> lock{ m_writer_mutex };
+        m_retired.push_back(m_current.exchange(model.release(), std::memory_order_seq_cst));
+        //Counted before the slots are scanned: a reader that clears its slot after the scan then sees the count
+        m_n_retired.store(m_retired.size(), std::memory_order_seq_cst);
+        reclaimLocked();
+    }
+
+    //Deletes the retired versions no reader holds any more and returns how many are left
+    size_t reclaim()
+    {
+        std::lock_guard<std::mutex> lock{ m_writer_mutex };
+        return reclaimLocked();
+    }
+
+    //Waits until every retired version has been deleted, like an RCU synchronize
+    void synchronize()
+    {
+        while (reclaim() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+};
@@ -1,87 +1,56 @@
 #include "neural_network.h"
+#include "chunked_source.h"
+#include "minibatch_pipeline.h"
 #include "rng.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <numeric>
 #include <fstream>
+#include <atomic>
 #include <sstream>
+#include <iomanip>
+#include <limits>
 
-Matrix NeuralNet::act_hidden(const Matrix& x) const
+namespace
 {
-    switch (m_hidden_af)
-    {
-    case ActivationFunction::identity:
-        return activation_functions::identity(x);
-    case ActivationFunction::sigmoid:
-        return activation_functions::sigmoid(x);
-    case ActivationFunction::tanh:
-        return activation_functions::tanh(x);
-    case ActivationFunction::relu:
-        return activation_functions::relu(x);
-    case ActivationFunction::softplus:
-        return activation_functions::softplus(x);
-    default:
-        return activation_functions::relu(x);
+    //The layout of the original two-function networks: hidden_af everywhere except the output layer
+    std::vector<ActivationFunction> expandActivations(const size_t n_layers, const ActivationFunction hidden_af, const ActivationFunction outer_af)
+    {
+        std::vector<ActivationFunction> activations(n_layers > 1 ? n_layers - 1 : 0, hidden_af);
+        if (!activations.empty())
+            activations.back() = outer_af;
+        return activations;
     }
-}
 
-Matrix NeuralNet::act_outer(const Matrix& x) const
-{
-    switch (m_outer_af)
-    {
-    case ActivationFunction::identity:
-        return activation_functions::identity(x);
-    case ActivationFunction::sigmoid:
-        return activation_functions::sigmoid(x);
-    case ActivationFunction::tanh:
-        return activation_functions::tanh(x);
-    case ActivationFunction::relu:
-        return activation_functions::relu(x);
-    case ActivationFunction::softplus:
-        return activation_functions::softplus(x);
-    default:
-        return activation_functions::identity(x);
+    RNG makeRng(const std::optional<unsigned int>& seed)
+    {
+        return seed ? RNG{ *seed } : RNG{};
     }
 }
 
-Matrix NeuralNet::act_hidden_der(const Matrix& x) const
+template <typename T>
+void BasicNeuralNet<T>::resolveActivations()
 {
-    switch (m_hidden_af)
-    {
-    case ActivationFunction::identity:
-        return activation_functions::identity_der(x);
-    case ActivationFunction::sigmoid:
-        return activation_functions::sigmoid_der(x);
-    case ActivationFunction::tanh:
-        return activation_functions::tanh_der(x);
-    case ActivationFunction::relu:
-        return activation_functions::relu_der(x);
-    case ActivationFunction::softplus:
-        return activation_functions::softplus_der(x);
-    default:
-        return activation_functions::relu_der(x);
+    if (m_activations.size() + 1 != m_layers.size())
+        throw std::invalid_argument("Need one activation function per layer after the input!");
+
+    m_activation_kernels.clear();
+    for (ActivationFunction activation : m_activations)
+    {
+        m_activation_kernels.push_back(activation_functions::kernelsFor<T>(activation));
     }
 }
 
-Matrix NeuralNet::act_outer_der(const Matrix& x) const
+template <typename T>
+BasicNeuralNet<T>::BasicNeuralNet(const std::vector<size_t> layers, const ActivationFunction hidden_af, const ActivationFunction outer_af, const std::optional<unsigned int> seed)
+    : BasicNeuralNet{ layers, expandActivations(layers.size(), hidden_af, outer_af), seed }
 {
-    switch (m_outer_af)
-    {
-    case ActivationFunction::identity:
-        return activation_functions::identity_der(x);
-    case ActivationFunction::sigmoid:
-        return activation_functions::sigmoid_der(x);
-    case ActivationFunction::tanh:
-        return activation_functions::tanh_der(x);
-    case ActivationFunction::relu:
-        return activation_functions::relu_der(x);
-    case ActivationFunction::softplus:
-        return activation_functions::softplus_der(x);
-    default:
-        return activation_functions::identity_der(x);
-    }
 }
 
-NeuralNet::NeuralNet(const std::vector<size_t> layers, const ActivationFunction hidden_af, const ActivationFunction outer_af)
-    : m_layers{ layers }, m_hidden_af{ hidden_af }, m_outer_af{ outer_af }, m_n_layers{ layers.size() }
+template <typename T>
+BasicNeuralNet<T>::BasicNeuralNet(const std::vector<size_t> layers, const std::vector<ActivationFunction> activations, const std::optional<unsigned int> seed)
+    : m_layers{ layers }, m_activations{ activations }, m_n_layers{ layers.size() }
 {
     if (layers.size() < 3)
         throw std::invalid_argument("Not enough layers!");
@@ -92,21 +61,24 @@ NeuralNet::NeuralNet(const std::vector<size_t> layers, const ActivationFunction
             throw std::invalid_argument("One of the layers is empty!");
     }
 
-    RNG rng{};
+    resolveActivations();
+
+    RNG rng{ makeRng(seed) };
+    m_init_seed = rng.seed();
 
     for (size_t i{ 1 }; i < layers.size(); i++)
     {
-        Matrix weights{ layers[i], layers[i - 1], std::vector<double>(layers[i] * layers[i - 1]) };
-        Matrix biases{ layers[i], 1, std::vector<double>(layers[i]) };
+        BasicMatrix<T> weights{ layers[i], layers[i - 1], std::vector<T>(layers[i] * layers[i - 1]) };
+        BasicMatrix<T> biases{ layers[i], 1, std::vector<T>(layers[i]) };
 
         for (int j{ 0 }; j < layers[i] * layers[i - 1]; j++)
         {
-            weights[j] = rng.generateFromNormal(0.0, sqrt(2.0 / static_cast<double>(layers[i - 1])));
+            weights[j] = static_cast<T>(rng.generateFromNormal(0.0, sqrt(2.0 / static_cast<double>(layers[i - 1]))));
         }
 
         for (int j{ 0 }; j < layers[i]; j++)
         {
-            biases[j] = rng.generateFromNormal(0.0, sqrt(2.0 / static_cast<double>(layers[i - 1])));
+            biases[j] = static_cast<T>(rng.generateFromNormal(0.0, sqrt(2.0 / static_cast<double>(layers[i - 1]))));
         }
 
         m_weights.push_back(weights);
@@ -114,15 +86,77 @@ NeuralNet::NeuralNet(const std::vector<size_t> layers, const ActivationFunction
     }
 }
 
-NeuralNet::NeuralNet(const std::string filename)
+template <typename T>
+BasicNeuralNet<T>::BasicNeuralNet(const std::string filename)
 {
     this->load(filename);
 }
 
-void NeuralNet::train(const Matrix& y_orig, const Matrix& x_orig, const double learning_rate, const size_t batch_size, const size_t epochs, const double l2_reg)
+template <typename T>
+template <typename U>
+BasicNeuralNet<T>::BasicNeuralNet(const BasicNeuralNet<U>& other_net)
+    : m_layers{ other_net.m_layers }, m_activations{ other_net.m_activations },
+    m_norm{ std::vector<T>(other_net.m_norm.first.begin(), other_net.m_norm.first.end()), std::vector<T>(other_net.m_norm.second.begin(), other_net.m_norm.second.end()) },
+    m_n_layers{ other_net.m_n_layers }, m_has_been_trained{ other_net.m_has_been_trained }, m_init_seed{ other_net.m_init_seed },
+    m_train_seed{ other_net.m_train_seed }
 {
-    Matrix y{ y_orig };
-    Matrix x{ x_orig };
+    for (size_t i{ 0 }; i < other_net.m_weights.size(); i++)
+    {
+        m_weights.push_back(BasicMatrix<T>{ other_net.m_weights[i] });
+        m_biases.push_back(BasicMatrix<T>{ other_net.m_biases[i] });
+    }
+    resolveActivations();
+}
+
+template <typename T>
+unsigned int BasicNeuralNet<T>::initSeed() const
+{
+    return m_init_seed;
+}
+
+template <typename T>
+unsigned int BasicNeuralNet<T>::trainSeed() const
+{
+    return m_train_seed;
+}
+
+template <typename T>
+const std::vector<size_t>& BasicNeuralNet<T>::layers() const
+{
+    return m_layers;
+}
+
+template <typename T>
+const std::vector<ActivationFunction>& BasicNeuralNet<T>::activations() const
+{
+    return m_activations;
+}
+
+template <typename T>
+const std::vector<BasicMatrix<T>>& BasicNeuralNet<T>::weights() const
+{
+    return m_weights;
+}
+
+template <typename T>
+const std::vector<BasicMatrix<T>>& BasicNeuralNet<T>::biases() const
+{
+    return m_biases;
+}
+
+template <typename T>
+const std::pair<std::vector<T>, std::vector<T>>& BasicNeuralNet<T>::normalization() const
+{
+    return m_norm;
+}
+
+template <typename T>
+void BasicNeuralNet<T>::train(const BasicMatrixView<T>& y_orig, const BasicMatrixView<T>& x_orig, const T learning_rate, const size_t batch_size, const size_t epochs, const T l2_reg,
+    const size_t n_threads, const TrainingMode mode, const std::optional<unsigned int> seed)
+{
+    parallel::ThreadLimit thread_limit{ n_threads };
+    BasicMatrix<T> y{ y_orig };
+    BasicMatrix<T> x{ x_orig };
 
     //Ensure the data parameters match the network specifications
     if (m_layers.at(0) != x.nCol() || m_layers.at(m_n_layers - 1) != y.nCol())
@@ -132,141 +166,456 @@ void NeuralNet::train(const Matrix& y_orig, const Matrix& x_orig, const double l
     normalizer(x);
 
     //Initialize random number generator
-    RNG rng{};
+    RNG rng{ makeRng(seed) };
+    m_train_seed = rng.seed();
 
     //Initialize some useful variables
     size_t n_rows{ x.nRow() };
-    size_t n_iters_per_epoch = static_cast<size_t>(ceil(static_cast<double>(n_rows) / static_cast<double>(batch_size)));
 
     //Create an index vector which will be used to loop through the data
     std::vector<size_t> shuffled_batch_idx(n_rows);
     //Populate the index vector from 0 to n_rows
     std::iota(shuffled_batch_idx.begin(), shuffled_batch_idx.end(), 0);
 
-    //Initialize the node value vector of matrices
-    std::vector<Matrix> node_vals(m_n_layers - 1);
-    std::vector<Matrix> node_vals_der(m_n_layers - 1);
-
-    //Initialize the gradient and bias gradient matrices
-    std::vector<Matrix> weights_grad{ m_weights };
-    std::vector<Matrix> biases_grad{ m_biases };
+    //One workspace per shard or asynchronous worker; a serial run is a single shard covering the whole minibatch
+    size_t n_shards{ mode == TrainingMode::serial ? 1 : parallel::numThreads() };
+    std::vector<Workspace> workspaces(n_shards);
+    std::vector<T> shard_errors(n_shards);
+    BasicMinibatchPipeline<T> pipeline{};
 
     //Loop through epochs
     for (size_t cur_epoch{ 0 }; cur_epoch < epochs; cur_epoch++)
     {
         //Shuffle the index vector
         rng.shuffleVector(shuffled_batch_idx);
-        //Epoch error
-        double epoch_error{ 0.0 };
+        double epoch_error{ runMinibatches(y, x, shuffled_batch_idx, learning_rate, batch_size, l2_reg, mode, workspaces, shard_errors, pipeline) };
+
+        //Output the epoch number and error
+        std::cout << "Epoch: " << cur_epoch + 1 << '\t' << "Error: " << epoch_error / static_cast<double>(n_rows * y.nCol()) << '\n';
+    }
+}
 
-        //Loop through iterations within the epoch
-        for (size_t i{ 0 }; i < n_iters_per_epoch; i++)
+template <typename T>
+void BasicNeuralNet<T>::trainStreaming(const BasicChunkedSource<T>& source, const T learning_rate, const size_t batch_size, const size_t epochs, const T l2_reg,
+    const size_t buffer_chunks, const size_t n_threads, const TrainingMode mode, const std::optional<unsigned int> seed)
+{
+    parallel::ThreadLimit thread_limit{ n_threads };
+    if (m_layers.at(0) != source.nFeatures() || m_layers.at(m_n_layers - 1) != source.nLabels())
+        throw std::invalid_argument("Layer size mismatch!");
+    if (buffer_chunks == 0)
+        throw std::invalid_argument("Buffer must hold at least one chunk!");
+    size_t n_chunks{ source.nChunks() };
+    if (n_chunks == 0)
+        throw std::invalid_argument("No training data!");
+
+    //First pass: column means and standard deviations of every chunk, merged into the running ones with the
+    //pairwise update of Chan et al. so that no chunk has to be revisited; accumulated in double
+    size_t n_features{ source.nFeatures() };
+    std::vector<double> mean(n_features);
+    std::vector<double> sum_sq_dev(n_features);
+    std::vector<double> chunk_mean(n_features);
+    std::vector<double> chunk_sum_sq_dev(n_features);
+    double n_seen{ 0.0 };
+    BasicMatrix<T> y_chunk{};
+    BasicMatrix<T> x_chunk{};
+    for (size_t c{ 0 }; c < n_chunks; c++)
+    {
+        source.readChunk(c, y_chunk, x_chunk);
+        double n_chunk_rows{ static_cast<double>(x_chunk.nRow()) };
+        std::fill(chunk_mean.begin(), chunk_mean.end(), 0.0);
+        std::fill(chunk_sum_sq_dev.begin(), chunk_sum_sq_dev.end(), 0.0);
+        for (size_t row{ 0 }; row < x_chunk.nRow(); row++)
         {
-            //Zero the gradients
-            for (size_t j{ 0 }; j < weights_grad.size(); j++)
+            for (size_t col{ 0 }; col < n_features; col++)
             {
-                weights_grad[j].zeroMe();
-                biases_grad[j].zeroMe();
+                chunk_mean[col] += x_chunk(row, col);
             }
+        }
+        for (size_t col{ 0 }; col < n_features; col++)
+        {
+            chunk_mean[col] /= n_chunk_rows;
+        }
+        for (size_t row{ 0 }; row < x_chunk.nRow(); row++)
+        {
+            for (size_t col{ 0 }; col < n_features; col++)
+            {
+                double deviation{ x_chunk(row, col) - chunk_mean[col] };
+                chunk_sum_sq_dev[col] += deviation * deviation;
+            }
+        }
+
+        double n_total{ n_seen + n_chunk_rows };
+        for (size_t col{ 0 }; col < n_features; col++)
+        {
+            double delta{ chunk_mean[col] - mean[col] };
+            mean[col] += delta * n_chunk_rows / n_total;
+            sum_sq_dev[col] += chunk_sum_sq_dev[col] + delta * delta * n_seen * n_chunk_rows / n_total;
+        }
+        n_seen = n_total;
+    }
 
-            //Get the indexes used in this iteration
-            std::vector<size_t> iter_idx{ sliceVector(shuffled_batch_idx, i * batch_size, std::min((i + 1) * batch_size, n_rows)) };
-            
-            Matrix x_vec{ x.getRows(iter_idx).transpose() };
-            Matrix y_vec{ y.getRows(iter_idx).transpose() };
+    m_norm.first.clear();
+    m_norm.second.clear();
+    for (size_t col{ 0 }; col < n_features; col++)
+    {
+        m_norm.first.push_back(static_cast<T>(mean[col]));
+        m_norm.second.push_back(static_cast<T>(std::sqrt(sum_sq_dev[col] / n_seen)));
+    }
+    checkNormalization();
+
+    RNG rng{ makeRng(seed) };
+    m_train_seed = rng.seed();
+    std::vector<size_t> chunk_order(n_chunks);
+    std::iota(chunk_order.begin(), chunk_order.end(), 0);
+    std::vector<size_t> row_order{};
+
+    size_t n_shards{ mode == TrainingMode::serial ? 1 : parallel::numThreads() };
+    std::vector<Workspace> workspaces(n_shards);
+    std::vector<T> shard_errors(n_shards);
+    BasicMatrix<T> y_buffer{};
+    BasicMatrix<T> x_buffer{};
+    BasicMinibatchPipeline<T> pipeline{};
+
+    for (size_t cur_epoch{ 0 }; cur_epoch < epochs; cur_epoch++)
+    {
+        rng.shuffleVector(chunk_order);
+        double epoch_error{ 0.0 };
 
-            //Calculates node values at each layer
-            node_vals[0] = act_hidden((m_weights[0] * x_vec).addColumnwise(m_biases[0]));
-            node_vals_der[0] = act_hidden_der((m_weights[0] * x_vec).addColumnwise(m_biases[0]));
-            for (int k{ 1 }; k < node_vals.size() - 1; k++)
+        for (size_t first_chunk{ 0 }; first_chunk < n_chunks; first_chunk += buffer_chunks)
+        {
+            //Appends the next chunks of this epoch's order to the buffer; BasicMatrix::resize guarantees to keep the rows
+            //already there, and the allocation stops growing once the largest buffer has been seen
+            size_t n_buffer_rows{ 0 };
+            y_buffer.resize(0, 0);
+            x_buffer.resize(0, 0);
+            for (size_t c{ first_chunk }; c < std::min(first_chunk + buffer_chunks, n_chunks); c++)
             {
-                node_vals[k] = act_hidden((m_weights[k] * node_vals[k - 1]).addColumnwise(m_biases[k]));
-                node_vals_der[k] = act_hidden_der((m_weights[k] * node_vals[k - 1]).addColumnwise(m_biases[k]));
+                source.readChunk(chunk_order[c], y_chunk, x_chunk);
+                y_buffer.resize(n_buffer_rows + y_chunk.nRow(), y_chunk.nCol());
+                x_buffer.resize(n_buffer_rows + x_chunk.nRow(), x_chunk.nCol());
+                std::copy(y_chunk.data(), y_chunk.data() + y_chunk.size(), y_buffer.data() + n_buffer_rows * y_chunk.nCol());
+                std::copy(x_chunk.data(), x_chunk.data() + x_chunk.size(), x_buffer.data() + n_buffer_rows * x_chunk.nCol());
+                n_buffer_rows += x_chunk.nRow();
             }
-            node_vals[node_vals.size() - 1] = act_outer((m_weights[node_vals.size() - 1] * node_vals[node_vals.size() - 2]).addColumnwise(m_biases[node_vals.size() - 1]));
-            node_vals_der[node_vals.size() - 1] = act_outer_der((m_weights[node_vals.size() - 1] * node_vals[node_vals.size() - 2]).addColumnwise(m_biases[node_vals.size() - 1]));
+            applyNormalizer(x_buffer);
 
-            //Get the current prediction
-            Matrix y_hat{ node_vals[node_vals.size() - 1] };
-            //Difference between predicted and actuals
-            Matrix y_delta{ y_hat - y_vec };
+            row_order.resize(n_buffer_rows);
+            std::iota(row_order.begin(), row_order.end(), 0);
+            rng.shuffleVector(row_order);
+            epoch_error += runMinibatches(y_buffer, x_buffer, row_order, learning_rate, batch_size, l2_reg, mode, workspaces, shard_errors, pipeline);
+        }
+
+        std::cout << "Epoch: " << cur_epoch + 1 << '\t' << "Error: " << epoch_error / static_cast<double>(source.nRows() * source.nLabels()) << '\n';
+    }
+}
 
-            //Add to the epoch error
-            epoch_error += y_delta.dotProduct(y_delta);
+template <typename T>
+double BasicNeuralNet<T>::runMinibatches(const BasicMatrix<T>& y, const BasicMatrix<T>& x, const std::vector<size_t>& row_order, const T learning_rate, const size_t batch_size,
+    const T l2_reg, const TrainingMode mode, std::vector<Workspace>& workspaces, std::vector<T>& shard_errors, BasicMinibatchPipeline<T>& pipeline)
+{
+    size_t n_rows{ row_order.size() };
+    size_t n_batches{ (n_rows + batch_size - 1) / batch_size };
+    size_t n_shards{ workspaces.size() };
+    double epoch_error{ 0.0 };
 
-            //Loop through the layers
-            for (int k{ 0 }; k < weights_grad.size(); k++)
+    if (mode == TrainingMode::hogwild)
+    {
+        //Workers pull minibatches off a shared counter and apply their updates as soon as they have them,
+        //each computing its gradient from a snapshot that may already be stale
+        std::atomic<size_t> next_batch{ 0 };
+        parallel::forRange(n_shards, 1, [&](const size_t first_worker, const size_t last_worker)
             {
-                //Loop through rows of the weight matrix 
-                for (int l{ 0 }; l < weights_grad[k].nRow(); l++)
-                {                 
-                    //Calculate the derivative of y_hat w.r.t. bias
-                    Matrix bias_der{ node_vals_der[k].zeroButOneRow(l) };
-                    for (int m{ k + 1 }; m < weights_grad.size(); m++)
+                for (size_t w{ first_worker }; w < last_worker; w++)
+                {
+                    shard_errors[w] = 0;
+                    for (size_t i{ next_batch.fetch_add(1, std::memory_order_relaxed) }; i < n_batches; i = next_batch.fetch_add(1, std::memory_order_relaxed))
                     {
-                        bias_der = (node_vals_der[m]).hadamardProduct(m_weights[m] * bias_der);
+                        size_t first_row{ i * batch_size };
+                        size_t n_batch_rows{ std::min(batch_size, n_rows - first_row) };
+                        BasicMatrixView<T> x_vec{ x.view().rowsAt(row_order.data() + first_row, n_batch_rows).transpose() };
+                        BasicMatrixView<T> y_vec{ y.view().rowsAt(row_order.data() + first_row, n_batch_rows).transpose() };
+
+                        snapshotParameters(workspaces[w]);
+                        shard_errors[w] += backpropagate(workspaces[w].weights, workspaces[w].biases, x_vec, y_vec, workspaces[w]);
+                        updateParametersRelaxed(workspaces[w], static_cast<T>(n_batch_rows), learning_rate, l2_reg);
                     }
-                    biases_grad[k][l] = y_delta.dotProduct(bias_der);
-                                        
-                    if (k == 0)
+                }
+            });
+
+        for (T worker_error : shard_errors)
+        {
+            epoch_error += worker_error;
+        }
+    }
+    else
+    {
+        //Loop through the minibatches; the pipeline gathers the next ones while this one trains
+        pipeline.start(y, x, row_order, batch_size);
+        for (size_t i{ 0 }; i < n_batches; i++)
+        {
+            const typename BasicMinibatchPipeline<T>::Batch& batch{ pipeline.next() };
+            size_t n_batch_rows{ batch.x_t.nCol() };
+
+            if (n_shards == 1)
+            {
+                epoch_error += backpropagate(m_weights, m_biases, batch.x_t, batch.y_t, workspaces[0]);
+            }
+            else
+            {
+                //Every shard gets a contiguous slice of the minibatch and computes its summed gradients on its own
+                size_t n_batch_shards{ std::min(n_shards, n_batch_rows) };
+                parallel::forRange(n_batch_shards, 1, [&](const size_t first_shard, const size_t last_shard)
                     {
-                        for (int m{ 0 }; m < weights_grad[k].nCol(); m++)
+                        for (size_t s{ first_shard }; s < last_shard; s++)
                         {
-                            weights_grad[k](l, m) = y_delta.dotProduct(bias_der.hadamardProduct(x_vec.getRow(m)));
+                            size_t shard_first_row{ n_batch_rows * s / n_batch_shards };
+                            size_t n_shard_rows{ n_batch_rows * (s + 1) / n_batch_shards - shard_first_row };
+                            BasicMatrixView<T> x_vec{ batch.x_t.view().cols(shard_first_row, n_shard_rows) };
+                            BasicMatrixView<T> y_vec{ batch.y_t.view().cols(shard_first_row, n_shard_rows) };
+                            shard_errors[s] = backpropagate(m_weights, m_biases, x_vec, y_vec, workspaces[s]);
                         }
-                    }
-                    else
-                    {
-                        for (int m{ 0 }; m < weights_grad[k].nCol(); m++)
+                    });
+
+                //Pairwise tree reduction into shard 0; the pairing depends only on the shard count, so the sums are reproducible
+                for (size_t stride{ 1 }; stride < n_batch_shards; stride *= 2)
+                {
+                    size_t n_pairs{ (n_batch_shards + 2 * stride - 1) / (2 * stride) };
+                    parallel::forRange(n_pairs, 1, [&](const size_t first_pair, const size_t last_pair)
                         {
-                            weights_grad[k](l, m) = y_delta.dotProduct(bias_der.hadamardProduct(node_vals[k - 1].getRow(m)));
-                        }
-                    }
+                            for (size_t p{ first_pair }; p < last_pair; p++)
+                            {
+                                size_t s{ 2 * stride * p };
+                                if (s + stride >= n_batch_shards)
+                                    continue;
+
+                                for (size_t k{ 0 }; k < m_weights.size(); k++)
+                                {
+                                    workspaces[s].weights_grad[k] += workspaces[s + stride].weights_grad[k];
+                                    workspaces[s].biases_grad[k] += workspaces[s + stride].biases_grad[k];
+                                }
+                                shard_errors[s] += shard_errors[s + stride];
+                            }
+                        });
                 }
-            }            
-            //Calculate the number of data points used in this iteration
-            double denominator{ static_cast<double>(iter_idx.size()) };
-
-            //Update the weights and biases
-            for (int j{ 0 }; j < weights_grad.size(); j++)
-            {
-                weights_grad[j] *= 2.0 / denominator;
-                //If regularization is positive we regularize
-                if (l2_reg > 0.0)
-                    m_weights[j] -= (weights_grad[j] * learning_rate + m_weights[j] * (l2_reg * learning_rate));
-                else
-                    m_weights[j] -= (weights_grad[j] * learning_rate);
-
-                biases_grad[j] *= 2.0 / denominator;
-                m_biases[j] -= biases_grad[j] * learning_rate;                
+                epoch_error += shard_errors[0];
             }
+
+            updateParameters(workspaces[0], static_cast<T>(n_batch_rows), learning_rate, l2_reg);
         }
-        //Output the epoch number and error
-        std::cout << "Epoch: " << cur_epoch + 1 << '\t' << "Error: " << epoch_error / static_cast<double>(n_rows * y.nCol()) << '\n';
+        pipeline.stop();
     }
+
+    return epoch_error;
 }
 
-Matrix NeuralNet::predict(const Matrix& x_orig) const
+template <typename T>
+T BasicNeuralNet<T>::backpropagate(const std::vector<BasicMatrix<T>>& weights, const std::vector<BasicMatrix<T>>& biases,
+    const BasicMatrixView<T>& x_vec, const BasicMatrixView<T>& y_vec, Workspace& workspace) const
 {
-    Matrix x{ x_orig };
+    std::vector<BasicMatrix<T>>& node_vals{ workspace.node_vals };
+    std::vector<BasicMatrix<T>>& node_vals_der{ workspace.node_vals_der };
+    std::vector<BasicMatrix<T>>& weights_grad{ workspace.weights_grad };
+    std::vector<BasicMatrix<T>>& biases_grad{ workspace.biases_grad };
+    BasicMatrix<T>& delta{ workspace.delta };
+
+    node_vals.resize(m_n_layers - 1);
+    node_vals_der.resize(m_n_layers - 1);
+    weights_grad.resize(weights.size());
+    biases_grad.resize(biases.size());
+
+    //Calculates node values at each layer: node_vals[k] first holds the pre-activation, which a single fused pass
+    //turns into the activation in place while writing its derivative to node_vals_der[k]
+    for (size_t k{ 0 }; k < node_vals.size(); k++)
+    {
+        multiplyInto(weights[k], k == 0 ? x_vec : node_vals[k - 1].view(), node_vals[k]);
+        node_vals[k] = node_vals[k].addColumnwise(biases[k]);
+
+        m_activation_kernels[k].apply_with_der(node_vals[k], node_vals[k], node_vals_der[k]);
+    }
+
+    //Difference between predicted and actuals
+    workspace.y_delta = node_vals[node_vals.size() - 1] - y_vec;
+
+    //Backpropagate layer by layer: delta holds the derivative of the error w.r.t. the pre-activations of layer k
+    delta = workspace.y_delta.hadamardProduct(node_vals_der[node_vals_der.size() - 1]);
+    for (size_t k{ weights_grad.size() }; k-- > 0;)
+    {
+        BasicMatrixView<T> layer_input{ k == 0 ? x_vec : node_vals[k - 1].view() };
+        multiplyInto(delta, layer_input.transpose(), weights_grad[k]);
+        rowwiseSumInto(delta, biases_grad[k]);
+
+        if (k > 0)
+        {
+            multiplyInto(weights[k].view().transpose(), delta, workspace.delta_propagated);
+            hadamardInto(workspace.delta_propagated, node_vals_der[k - 1], delta);
+        }
+    }
+
+    return workspace.y_delta.dotProduct(workspace.y_delta);
+}
+
+template <typename T>
+void BasicNeuralNet<T>::updateParameters(Workspace& workspace, const T denominator, const T learning_rate, const T l2_reg)
+{
+    std::vector<BasicMatrix<T>>& weights_grad{ workspace.weights_grad };
+    std::vector<BasicMatrix<T>>& biases_grad{ workspace.biases_grad };
+
+    //Update the weights and biases
+    for (size_t j{ 0 }; j < weights_grad.size(); j++)
+    {
+        weights_grad[j] *= T{ 2 } / denominator;
+        //If regularization is positive we regularize
+        if (l2_reg > 0)
+            m_weights[j] -= (weights_grad[j] * learning_rate + m_weights[j] * (l2_reg * learning_rate));
+        else
+            m_weights[j] -= (weights_grad[j] * learning_rate);
+
+        biases_grad[j] *= T{ 2 } / denominator;
+        m_biases[j] -= biases_grad[j] * learning_rate;
+    }
+}
+
+//Hogwild accesses to the shared parameters go through relaxed atomics: on the usual targets they compile to plain
+//loads and stores, so concurrent updates may overwrite each other, but every access is still well-defined
+template <typename T>
+void BasicNeuralNet<T>::snapshotParameters(Workspace& workspace)
+{
+    workspace.weights.resize(m_weights.size());
+    workspace.biases.resize(m_biases.size());
+
+    for (size_t j{ 0 }; j < m_weights.size(); j++)
+    {
+        workspace.weights[j].resize(m_weights[j].nRow(), m_weights[j].nCol());
+        for (size_t i{ 0 }; i < m_weights[j].size(); i++)
+        {
+            workspace.weights[j][i] = std::atomic_ref<T>{ m_weights[j][i] }.load(std::memory_order_relaxed);
+        }
+
+        workspace.biases[j].resize(m_biases[j].nRow(), m_biases[j].nCol());
+        for (size_t i{ 0 }; i < m_biases[j].size(); i++)
+        {
+            workspace.biases[j][i] = std::atomic_ref<T>{ m_biases[j][i] }.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+void BasicNeuralNet<T>::updateParametersRelaxed(Workspace& workspace, const T denominator, const T learning_rate, const T l2_reg)
+{
+    //Same arithmetic as updateParameters, element by element on the live parameters
+    for (size_t j{ 0 }; j < m_weights.size(); j++)
+    {
+        for (size_t i{ 0 }; i < m_weights[j].size(); i++)
+        {
+            std::atomic_ref<T> weight{ m_weights[j][i] };
+            T old_weight{ weight.load(std::memory_order_relaxed) };
+            T step{ workspace.weights_grad[j][i] * (T{ 2 } / denominator) * learning_rate };
+            if (l2_reg > 0)
+                step += old_weight * (l2_reg * learning_rate);
+            weight.store(old_weight - step, std::memory_order_relaxed);
+        }
+
+        for (size_t i{ 0 }; i < m_biases[j].size(); i++)
+        {
+            std::atomic_ref<T> bias{ m_biases[j][i] };
+            T step{ workspace.biases_grad[j][i] * (T{ 2 } / denominator) * learning_rate };
+            bias.store(bias.load(std::memory_order_relaxed) - step, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicNeuralNet<T>::predict(const BasicMatrixView<T>& x_orig, const size_t n_threads) const
+{
+    parallel::ThreadLimit thread_limit{ n_threads };
+    BasicMatrix<T> x{ x_orig };
     applyNormalizer(x);
-    Matrix result{ x.transpose() };
-    for (size_t i{ 0 }; i < m_weights.size() - 1; i++)
+    //The first layer reads the normalized rows through a transposed view instead of a transposed copy;
+    //the layers then alternate between two matrices and activate in place
+    BasicMatrix<T> result{};
+    BasicMatrix<T> layer_input{};
+    for (size_t i{ 0 }; i < m_weights.size(); i++)
+    {
+        multiplyInto(m_weights[i], i == 0 ? x.view().transpose() : layer_input.view(), result);
+        result = result.addColumnwise(m_biases[i]);
+        m_activation_kernels[i].apply(result, result);
+
+        std::swap(result, layer_input);
+    }
+    return layer_input.transpose();
+}
+
+template <typename T>
+void BasicNeuralNet<T>::predictOne(std::span<const T> features, std::span<T> out) const
+{
+    size_t scratch_size{ predictOneScratchSize() };
+    if (scratch_size <= 2 * PREDICT_ONE_STACK_WIDTH)
+    {
+        T stack_scratch[2 * PREDICT_ONE_STACK_WIDTH];
+        predictOne(features, out, std::span<T>{ stack_scratch, scratch_size });
+        return;
+    }
+
+    //Grows once per thread to the widest network it has scored
+    thread_local std::vector<T> wide_scratch{};
+    if (wide_scratch.size() < scratch_size)
+        wide_scratch.resize(scratch_size);
+    predictOne(features, out, std::span<T>{ wide_scratch.data(), scratch_size });
+}
+
+template <typename T>
+size_t BasicNeuralNet<T>::predictOneScratchSize() const
+{
+    return 2 * *std::max_element(m_layers.begin(), m_layers.end() - 1);
+}
+
+template <typename T>
+void BasicNeuralNet<T>::predictOne(std::span<const T> features, std::span<T> out, std::span<T> scratch) const
+{
+    if (features.size() != m_layers.front() || out.size() != m_layers.back())
+        throw std::invalid_argument("Layer size mismatch!");
+    if (m_norm.first.size() != m_layers.front())
+        throw std::invalid_argument("Network has not been trained!");
+    size_t widest{ predictOneScratchSize() / 2 };
+    if (scratch.size() < 2 * widest)
+        throw std::invalid_argument("Scratch is too small!");
+
+    T* input{ scratch.data() };
+    T* output{ scratch.data() + widest };
+    for (size_t col{ 0 }; col < features.size(); col++)
+    {
+        input[col] = (features[col] - m_norm.first[col]) / m_norm.second[col];
+    }
+
+    for (size_t i{ 0 }; i < m_weights.size(); i++)
     {
-        result = act_hidden((m_weights[i] * result).addColumnwise(m_biases[i]));
+        size_t n_in{ m_layers[i] };
+        if (i + 1 == m_weights.size())
+            output = out.data();
+
+        for (size_t row{ 0 }; row < m_layers[i + 1]; row++)
+        {
+            output[row] = simd::dot(m_weights[i].data() + row * n_in, input, n_in) + m_biases[i][row];
+        }
+        m_activation_kernels[i].map(output, output, m_layers[i + 1]);
+
+        std::swap(input, output);
     }
-    result = act_outer((m_weights[m_weights.size() - 1] * result).addColumnwise(m_biases[m_weights.size() - 1]));
-    return result.transpose();
 }
 
-void NeuralNet::save(const std::string filename) const
+template <typename T>
+void BasicNeuralNet<T>::save(const std::string filename) const
 {
     //Create an output stream class to operate on files
     std::ofstream outfile(filename);
+    //Write enough digits for the parameters to read back exactly in this precision
+    outfile << std::setprecision(std::numeric_limits<T>::max_digits10);
 
-    //Save network activation functions
-    outfile << static_cast<size_t>(m_hidden_af) << ',';
-    outfile << static_cast<size_t>(m_outer_af) << ',';
+    //Save network activation functions, one per weight layer
+    for (ActivationFunction activation : m_activations)
+    {
+        outfile << static_cast<size_t>(activation) << ',';
+    }
     outfile << '\n';
 
     //Save network dimensions
@@ -296,11 +645,26 @@ void NeuralNet::save(const std::string filename) const
             outfile << m_biases[i][j] << ',';
         }
     }
+
+    outfile << '\n';
+
+    //Save the input normalization, so a loaded network can predict straight away
+    for (T mean : m_norm.first)
+    {
+        outfile << mean << ',';
+    }
+    outfile << '\n';
+    for (T std_dev : m_norm.second)
+    {
+        outfile << std_dev << ',';
+    }
 }
 
-void NeuralNet::load(const std::string filename)
+template <typename T>
+void BasicNeuralNet<T>::load(const std::string filename)
 {
     m_layers.clear();
+    m_activations.clear();
     m_weights.clear();
     m_biases.clear();
     m_n_layers = 0;
@@ -312,16 +676,22 @@ void NeuralNet::load(const std::string filename)
         throw std::invalid_argument("Couldn't open file!");
 
     std::string line{ "" };
+    //Parameters are parsed as double and converted, so a file saved in either precision loads into either
     double data{ 0.0 };
     size_t data_size_t{ 0 };
 
     std::getline(infile, line);
+    //Frozen and quantized models have their normalization folded in and can't be trained further
+    if (line == "frozen" || line == "quantized")
+        throw std::invalid_argument("File holds an inference-only model, load it with FrozenNet or QuantizedNet!");
     std::istringstream iss_act{ line };
-    iss_act >> data_size_t;
-    m_hidden_af = static_cast<ActivationFunction>(data_size_t);
-    iss_act.ignore();
-    iss_act >> data_size_t;
-    m_outer_af = static_cast<ActivationFunction>(data_size_t);
+    while (iss_act >> data_size_t)
+    {
+        if (iss_act.peek() == ',')
+            iss_act.ignore();
+
+        m_activations.push_back(static_cast<ActivationFunction>(data_size_t));
+    }
     iss_act.str(std::string());
     iss_act.clear();
 
@@ -339,10 +709,15 @@ void NeuralNet::load(const std::string filename)
 
     m_n_layers = m_layers.size();
 
+    //Files written before per-layer activations hold just the hidden and the output function
+    if (m_activations.size() == 2 && m_n_layers > 3)
+        m_activations = expandActivations(m_n_layers, m_activations[0], m_activations[1]);
+    resolveActivations();
+
     for (size_t i{ 1 }; i < m_n_layers; i++)
     {
-        Matrix weights{ m_layers[i], m_layers[i - 1], std::vector<double>(m_layers[i] * m_layers[i - 1]) };
-        Matrix biases{ m_layers[i], 1, std::vector<double>(m_layers[i]) };
+        BasicMatrix<T> weights{ m_layers[i], m_layers[i - 1], std::vector<T>(m_layers[i] * m_layers[i - 1]) };
+        BasicMatrix<T> biases{ m_layers[i], 1, std::vector<T>(m_layers[i]) };
 
         m_weights.push_back(weights);
         m_biases.push_back(biases);
@@ -358,7 +733,7 @@ void NeuralNet::load(const std::string filename)
                 iss_weights.ignore();
 
             iss_weights >> data;
-            m_weights[i][j] = data;
+            m_weights[i][j] = static_cast<T>(data);
         }
     }
     iss_weights.str(std::string());
@@ -374,36 +749,65 @@ void NeuralNet::load(const std::string filename)
                 iss_biases.ignore();
 
             iss_biases >> data;
-            m_biases[i][j] = data;
+            m_biases[i][j] = static_cast<T>(data);
         }
     }
     iss_biases.str(std::string());
     iss_biases.clear();    
+
+    //Files written before the normalization was saved end here and leave the network untrained
+    m_norm.first.clear();
+    m_norm.second.clear();
+    std::getline(infile, line);
+    std::istringstream iss_mean{ line };
+    while (iss_mean >> data)
+    {
+        if (iss_mean.peek() == ',')
+            iss_mean.ignore();
+
+        m_norm.first.push_back(static_cast<T>(data));
+    }
+    std::getline(infile, line);
+    std::istringstream iss_std_dev{ line };
+    while (iss_std_dev >> data)
+    {
+        if (iss_std_dev.peek() == ',')
+            iss_std_dev.ignore();
+
+        m_norm.second.push_back(static_cast<T>(data));
+    }
 }
 
-void NeuralNet::normalizer(Matrix& x)
+template <typename T>
+void BasicNeuralNet<T>::normalizer(BasicMatrix<T>& x)
 {
     m_norm.first = x.columnwiseMean();
     m_norm.second = x.columnwiseStdDev();
+    checkNormalization();
 
-    for (double std_dev : m_norm.second)
+    for (size_t row{ 0 }; row < x.nRow(); row++)
     {
-        if (std_dev == 0.0)
+        for (size_t col{ 0 }; col < x.nCol(); col++)
         {
-            throw std::invalid_argument("Standard devaition is zero for one of the variables!");
+            x(row, col) = (x(row, col) - m_norm.first[col]) / m_norm.second[col];
         }
     }
+}
 
-    for (size_t row{ 0 }; row < x.nRow(); row++)
+template <typename T>
+void BasicNeuralNet<T>::checkNormalization() const
+{
+    for (T std_dev : m_norm.second)
     {
-        for (size_t col{ 0 }; col < x.nCol(); col++)
+        if (std_dev == 0)
         {
-            x(row, col) = (x(row, col) - m_norm.first[col]) / m_norm.second[col];
+            throw std::invalid_argument("Standard devaition is zero for one of the variables!");
         }
     }
 }
 
-void NeuralNet::applyNormalizer(Matrix& x) const
+template <typename T>
+void BasicNeuralNet<T>::applyNormalizer(BasicMatrix<T>& x) const
 {
     for (size_t row{ 0 }; row < x.nRow(); row++)
     {
@@ -412,4 +816,9 @@ void NeuralNet::applyNormalizer(Matrix& x) const
             x(row, col) = (x(row, col) - m_norm.first[col]) / m_norm.second[col];
         }
     }
-}
\ No newline at end of file
+}
+
+template class BasicNeuralNet<float>;
+template class BasicNeuralNet<double>;
+template BasicNeuralNet<float>::BasicNeuralNet(const BasicNeuralNet<double>& other_net);
+template BasicNeuralNet<double>::BasicNeuralNet(const BasicNeuralNet<float>& other_net);
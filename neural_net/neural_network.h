@@ -1,31 +1,124 @@
 #pragma once
 #include "math.h"
+#include <optional>
+#include <span>
 
-class NeuralNet
+enum class TrainingMode
+{
+    serial,
+    data_parallel,
+    hogwild
+};
+
+template <typename T>
+class BasicChunkedSource;
+
+template <typename T>
+class BasicMinibatchPipeline;
+
+template <typename T>
+class BasicNeuralNet
 {
 private:
-    ActivationFunction m_hidden_af{};
-    ActivationFunction m_outer_af{};
+    template <typename U>
+    friend class BasicNeuralNet;
+
     std::vector<size_t> m_layers{};
-    std::vector<Matrix> m_weights{};
-    std::vector<Matrix> m_biases{};
-    std::pair<std::vector<double>, std::vector<double>> m_norm{};
+    //One activation per weight layer, and its kernels resolved by resolveActivations()
+    std::vector<ActivationFunction> m_activations{};
+    std::vector<ActivationKernels<T>> m_activation_kernels{};
+    std::vector<BasicMatrix<T>> m_weights{};
+    std::vector<BasicMatrix<T>> m_biases{};
+    std::pair<std::vector<T>, std::vector<T>> m_norm{};
     size_t m_n_layers{};
     bool m_has_been_trained{};
+    unsigned int m_init_seed{};
+    unsigned int m_train_seed{};
 
-    Matrix act_hidden(const Matrix& x) const;
-    Matrix act_outer(const Matrix& x) const;
-    Matrix act_hidden_der(const Matrix& x) const;
-    Matrix act_outer_der(const Matrix& x) const;
+    void resolveActivations();
+
+    static constexpr size_t PREDICT_ONE_STACK_WIDTH{ 512 };
+
+    //Scratch matrices of one forward and backward pass; they keep their allocations between minibatches
+    struct Workspace
+    {
+        std::vector<BasicMatrix<T>> node_vals{};
+        std::vector<BasicMatrix<T>> node_vals_der{};
+        std::vector<BasicMatrix<T>> weights_grad{};
+        std::vector<BasicMatrix<T>> biases_grad{};
+        BasicMatrix<T> y_delta{};
+        BasicMatrix<T> delta{};
+        BasicMatrix<T> delta_propagated{};
+        //Private copy of the parameters in hogwild mode
+        std::vector<BasicMatrix<T>> weights{};
+        std::vector<BasicMatrix<T>> biases{};
+    };
+
+    //Leaves the gradients of the summed squared error over the columns of x_vec in the workspace and returns that error
+    T backpropagate(const std::vector<BasicMatrix<T>>& weights, const std::vector<BasicMatrix<T>>& biases,
+        const BasicMatrixView<T>& x_vec, const BasicMatrixView<T>& y_vec, Workspace& workspace) const;
+    //Runs the minibatch updates of one pass over the rows of x and y in row_order and returns their summed squared error.
+    //Serial and data-parallel passes train on minibatches the pipeline gathers in the background.
+    double runMinibatches(const BasicMatrix<T>& y, const BasicMatrix<T>& x, const std::vector<size_t>& row_order, const T learning_rate, const size_t batch_size,
+        const T l2_reg, const TrainingMode mode, std::vector<Workspace>& workspaces, std::vector<T>& shard_errors, BasicMinibatchPipeline<T>& pipeline);
+    void checkNormalization() const;
+    void updateParameters(Workspace& workspace, const T denominator, const T learning_rate, const T l2_reg);
+    void snapshotParameters(Workspace& workspace);
+    void updateParametersRelaxed(Workspace& workspace, const T denominator, const T learning_rate, const T l2_reg);
 
 public:
-    NeuralNet(const std::vector<size_t> layers, const ActivationFunction hidden_af, const ActivationFunction outer_af);
-    NeuralNet(const std::string filename);
+    //hidden_af is used by every layer but the last, which uses outer_af.
+    //seed fixes the weight initialization; without one it is drawn from std::random_device and kept in initSeed().
+    BasicNeuralNet(const std::vector<size_t> layers, const ActivationFunction hidden_af, const ActivationFunction outer_af, const std::optional<unsigned int> seed = std::nullopt);
+    //activations holds one entry per layer after the input
+    BasicNeuralNet(const std::vector<size_t> layers, const std::vector<ActivationFunction> activations, const std::optional<unsigned int> seed = std::nullopt);
+    BasicNeuralNet(const std::string filename);
+    //Converts a network of the other precision, e.g. to run a double-trained model in float
+    template <typename U>
+    explicit BasicNeuralNet(const BasicNeuralNet<U>& other_net);
 
-    void train(const Matrix& y_orig, const Matrix& x_orig, const double learning_rate = 0.01, const size_t batch_size = 10000, const size_t epochs = 10, const double l2_reg = 0.0);
-    Matrix predict(const Matrix& x_orig) const;
+    //n_threads limits the threads the matrix operations of this call use; 0 keeps the process-wide setting.
+    //In data_parallel mode every minibatch is split into one shard per thread and the shard gradients are summed
+    //in a fixed order, so results are reproducible for a given seed and thread count.
+    //In hogwild mode every thread takes whole minibatches and updates the shared parameters without locking;
+    //results then depend on scheduling.
+    //y_orig and x_orig may be matrices or views, e.g. onto a memory-mapped dataset; training normalizes a copy of x.
+    //seed fixes the shuffling; without one it is drawn from std::random_device. Either way it is kept in trainSeed(),
+    //so a run can be repeated from the same initSeed() and trainSeed().
+    void train(const BasicMatrixView<T>& y_orig, const BasicMatrixView<T>& x_orig, const T learning_rate = 0.01, const size_t batch_size = 10000, const size_t epochs = 10, const T l2_reg = 0.0,
+        const size_t n_threads = 0, const TrainingMode mode = TrainingMode::serial, const std::optional<unsigned int> seed = std::nullopt);
+    //Trains on a source read a chunk at a time, for data larger than memory. A first pass over every chunk computes the
+    //normalization. Each epoch visits the chunks in a new random order, buffer_chunks at a time: the buffered rows are
+    //normalized, shuffled together and run through minibatches as in train, so no minibatch spans two buffers.
+    //Memory stays at about buffer_chunks + 1 chunks plus the minibatch workspaces, whatever the size of the source.
+    //The chunk and row shuffles are seeded as in train.
+    void trainStreaming(const BasicChunkedSource<T>& source, const T learning_rate = 0.01, const size_t batch_size = 10000, const size_t epochs = 10, const T l2_reg = 0.0,
+        const size_t buffer_chunks = 4, const size_t n_threads = 0, const TrainingMode mode = TrainingMode::serial, const std::optional<unsigned int> seed = std::nullopt);
+    //Seeds the weights were initialized and the last training run was shuffled with; 0 for a loaded network
+    unsigned int initSeed() const;
+    unsigned int trainSeed() const;
+    BasicMatrix<T> predict(const BasicMatrixView<T>& x_orig, const size_t n_threads = 0) const;
+    //Scores one row of raw features into out, which must hold one value per output node.
+    //Works layer by layer with matrix-vector products on the stored weights and scratch on the stack
+    //(or a per-thread buffer for layers wider than PREDICT_ONE_STACK_WIDTH), and may run concurrently on the same network.
+    //It never allocates for networks up to PREDICT_ONE_STACK_WIDTH wide; wider ones allocate the per-thread buffer on
+    //each thread's first call, which the overload taking scratch avoids.
+    void predictOne(std::span<const T> features, std::span<T> out) const;
+    //As above with caller-owned scratch of at least predictOneScratchSize() values, so no network width allocates
+    void predictOne(std::span<const T> features, std::span<T> out, std::span<T> scratch) const;
+    size_t predictOneScratchSize() const;
+    //Read-only access to the trained model, for exporters and inference engines
+    const std::vector<size_t>& layers() const;
+    const std::vector<ActivationFunction>& activations() const;
+    const std::vector<BasicMatrix<T>>& weights() const;
+    const std::vector<BasicMatrix<T>>& biases() const;
+    //Column means and standard deviations the inputs are normalized with; empty until the network is trained
+    const std::pair<std::vector<T>, std::vector<T>>& normalization() const;
     void save(const std::string filename) const;
     void load(const std::string filename);
-    void normalizer(Matrix& x);
-    void applyNormalizer(Matrix& x) const;
-};
\ No newline at end of file
+    void normalizer(BasicMatrix<T>& x);
+    void applyNormalizer(BasicMatrix<T>& x) const;
+};
+
+using NeuralNet = BasicNeuralNet<double>;
+using FloatNeuralNet = BasicNeuralNet<float>;
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include "quantized_net.h"
+#include "gemm.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+    //First line of a quantized model file
+    const std::string QUANTIZED_MODEL_TAG{ "quantized" };
+
+    template <typename U>
+    void writeLine(std::ofstream& outfile, const std::vector<U>& values)
+    {
+        for (U value : values)
+        {
+            //Bytes would otherwise go out as characters
+            if constexpr (std::is_integral_v<U>)
+                outfile << static_cast<int>(value) << ',';
+            else
+                outfile << value << ',';
+        }
+    }
+
+    template <typename U>
+    void readValues(std::istringstream& iss, std::vector<U>& values, const size_t count)
+    {
+        //Parsed as double and converted, so a model quantized in either precision loads into either
+        double data{ 0.0 };
+        values.resize(count);
+        for (U& value : values)
+        {
+            if (!(iss >> data))
+                throw std::invalid_argument("Quantized model file is missing parameters!");
+            if (iss.peek() == ',')
+                iss.ignore();
+
+            value = static_cast<U>(data);
+        }
+    }
+}
+
+template <typename T>
+BasicQuantizedNet<T>::BasicQuantizedNet(const BasicFrozenNet<T>& model, const BasicMatrix<T>& calibration_x)
+    : m_layers{ model.layers() }, m_activations{ model.activations() }
+{
+    if (calibration_x.nRow() == 0 || calibration_x.nCol() != model.nInputs())
+        throw std::invalid_argument("Calibration data does not match the network!");
+
+    //The float model's activations on the calibration rows, layer by layer
+    size_t n_rows{ calibration_x.nRow() };
+    std::vector<T> layer_input(calibration_x.data(), calibration_x.data() + calibration_x.size());
+    std::vector<T> layer_output{};
+    for (size_t i{ 0 }; i + 1 < m_layers.size(); i++)
+    {
+        size_t n_in{ m_layers[i] };
+        size_t n_out{ m_layers[i + 1] };
+        Layer layer{};
+
+        //The range always contains zero, so zero is exact and the bias terms stay unbiased
+        for (size_t col{ 0 }; col < n_in; col++)
+        {
+            double low{ 0.0 };
+            double high{ 0.0 };
+            for (size_t row{ 0 }; row < n_rows; row++)
+            {
+                low = std::min(low, static_cast<double>(layer_input[row * n_in + col]));
+                high = std::max(high, static_cast<double>(layer_input[row * n_in + col]));
+            }
+            double scale{ high > low ? (high - low) / 255.0 : 1.0 };
+            layer.input_scales.push_back(static_cast<T>(scale));
+            layer.zero_points.push_back(static_cast<std::uint8_t>(std::clamp(std::round(-low / scale), 0.0, 255.0)));
+        }
+
+        //Row j of the quantized weights is column j of the frozen n_in x n_out weights, times the input scales
+        BasicMatrixView<T> weights{ model.weights(i) };
+        const T* biases{ model.biases(i) };
+        layer.weights.resize(n_out * n_in);
+        for (size_t row{ 0 }; row < n_out; row++)
+        {
+            double largest{ 0.0 };
+            for (size_t col{ 0 }; col < n_in; col++)
+            {
+                largest = std::max(largest, std::abs(static_cast<double>(weights(col, row)) * static_cast<double>(layer.input_scales[col])));
+            }
+            double weight_scale{ largest > 0.0 ? largest / 127.0 : 1.0 };
+            for (size_t col{ 0 }; col < n_in; col++)
+            {
+                double folded{ static_cast<double>(weights(col, row)) * static_cast<double>(layer.input_scales[col]) };
+                layer.weights[row * n_in + col] = static_cast<std::int8_t>(std::round(folded / weight_scale));
+            }
+            layer.weight_scales.push_back(static_cast<T>(weight_scale));
+            layer.biases.push_back(biases[row]);
+        }
+        m_quantized.push_back(std::move(layer));
+
+        //Calibrate the next layer on the float model's output, not the quantized one
+        layer_output.resize(n_rows * n_out);
+        gemm::multiply(BasicMatrixView<T>{ layer_input.data(), n_rows, n_in, n_in }, weights, layer_output.data(), n_out);
+        for (size_t row{ 0 }; row < n_rows; row++)
+        {
+            simd::add(layer_output.data() + row * n_out, layer_output.data() + row * n_out, biases, n_out);
+        }
+        activation_functions::kernelsFor<T>(m_activations[i]).map(layer_output.data(), layer_output.data(), layer_output.size());
+        std::swap(layer_input, layer_output);
+    }
+
+    prepare();
+}
+
+template <typename T>
+BasicQuantizedNet<T>::BasicQuantizedNet(const BasicNeuralNet<T>& net, const BasicMatrix<T>& calibration_x)
+    : BasicQuantizedNet{ BasicFrozenNet<T>{ net }, calibration_x }
+{
+}
+
+template <typename T>
+BasicQuantizedNet<T>::BasicQuantizedNet(const std::string filename)
+{
+    this->load(filename);
+}
+
+template <typename T>
+void BasicQuantizedNet<T>::prepare()
+{
+    m_activation_kernels.clear();
+    for (ActivationFunction activation : m_activations)
+    {
+        m_activation_kernels.push_back(activation_functions::kernelsFor<T>(activation));
+    }
+
+    //x_col ~ input_scale_col (q_col - zero_point_col) and input_scale_col w_col,row ~ weight_scale_row q_row,col, so
+    //the output is weight_scale_row (sum of q_col q_row,col - sum of zero_point_col q_row,col) + bias_row
+    for (size_t i{ 0 }; i < m_quantized.size(); i++)
+    {
+        Layer& layer{ m_quantized[i] };
+        size_t n_in{ m_layers[i] };
+        layer.inverse_scales.clear();
+        layer.offsets.clear();
+        for (T scale : layer.input_scales)
+        {
+            layer.inverse_scales.push_back(T{ 1 } / scale);
+        }
+        for (size_t row{ 0 }; row < m_layers[i + 1]; row++)
+        {
+            std::int64_t zero_point_sum{ 0 };
+            for (size_t col{ 0 }; col < n_in; col++)
+            {
+                zero_point_sum += std::int64_t{ layer.zero_points[col] } * layer.weights[row * n_in + col];
+            }
+            layer.offsets.push_back(layer.biases[row] - layer.weight_scales[row] * static_cast<T>(zero_point_sum));
+        }
+    }
+}
+
+template <typename T>
+void BasicQuantizedNet<T>::save(const std::string filename) const
+{
+    std::ofstream outfile(filename);
+    outfile << std::setprecision(std::numeric_limits<T>::max_digits10);
+
+    outfile << QUANTIZED_MODEL_TAG << '\n';
+    for (ActivationFunction activation : m_activations)
+    {
+        outfile << static_cast<size_t>(activation) << ',';
+    }
+    outfile << '\n';
+    writeLine(outfile, m_layers);
+    outfile << '\n';
+
+    //One line per kind of parameter, each running through the layers in order
+    for (const Layer& layer : m_quantized)
+    {
+        writeLine(outfile, layer.input_scales);
+    }
+    outfile << '\n';
+    for (const Layer& layer : m_quantized)
+    {
+        writeLine(outfile, layer.zero_points);
+    }
+    outfile << '\n';
+    for (const Layer& layer : m_quantized)
+    {
+        writeLine(outfile, layer.weights);
+    }
+    outfile << '\n';
+    for (const Layer& layer : m_quantized)
+    {
+        writeLine(outfile, layer.weight_scales);
+    }
+    outfile << '\n';
+    for (const Layer& layer : m_quantized)
+    {
+        writeLine(outfile, layer.biases);
+    }
+    outfile << '\n';
+}
+
+template <typename T>
+void BasicQuantizedNet<T>::load(const std::string filename)
+{
+    m_layers.clear();
+    m_activations.clear();
+    m_quantized.clear();
+
+    std::ifstream infile(filename);
+
+    if (!infile.good())
+        throw std::invalid_argument("Couldn't open file!");
+
+    std::string line{ "" };
+    std::getline(infile, line);
+    if (line != QUANTIZED_MODEL_TAG)
+        throw std::invalid_argument("File does not hold a quantized model!");
+
+    size_t data_size_t{ 0 };
+    std::getline(infile, line);
+    std::istringstream iss_act{ line };
+    while (iss_act >> data_size_t)
+    {
+        if (iss_act.peek() == ',')
+            iss_act.ignore();
+
+        m_activations.push_back(static_cast<ActivationFunction>(data_size_t));
+    }
+
+    std::getline(infile, line);
+    std::istringstream iss_layers{ line };
+    while (iss_layers >> data_size_t)
+    {
+        if (iss_layers.peek() == ',')
+            iss_layers.ignore();
+
+        m_layers.push_back(data_size_t);
+    }
+
+    if (m_layers.size() < 2 || m_activations.size() != m_layers.size() - 1)
+        throw std::invalid_argument("Need one activation function per layer after the input!");
+    m_quantized.resize(m_layers.size() - 1);
+
+    std::getline(infile, line);
+    std::istringstream iss_input_scales{ line };
+    for (size_t i{ 0 }; i < m_quantized.size(); i++)
+    {
+        readValues(iss_input_scales, m_quantized[i].input_scales, m_layers[i]);
+    }
+    std::getline(infile, line);
+    std::istringstream iss_zero_points{ line };
+    for (size_t i{ 0 }; i < m_quantized.size(); i++)
+    {
+        readValues(iss_zero_points, m_quantized[i].zero_points, m_layers[i]);
+    }
+    std::getline(infile, line);
+    std::istringstream iss_weights{ line };
+    for (size_t i{ 0 }; i < m_quantized.size(); i++)
+    {
+        readValues(iss_weights, m_quantized[i].weights, m_layers[i] * m_layers[i + 1]);
+    }
+    std::getline(infile, line);
+    std::istringstream iss_weight_scales{ line };
+    for (size_t i{ 0 }; i < m_quantized.size(); i++)
+    {
+        readValues(iss_weight_scales, m_quantized[i].weight_scales, m_layers[i + 1]);
+    }
+    std::getline(infile, line);
+    std::istringstream iss_biases{ line };
+    for (size_t i{ 0 }; i < m_quantized.size(); i++)
+    {
+        readValues(iss_biases, m_quantized[i].biases, m_layers[i + 1]);
+    }
+
+    prepare();
+}
+
+template <typename T>
+const std::vector<size_t>& BasicQuantizedNet<T>::layers() const
+{
+    return m_layers;
+}
+
+template <typename T>
+const std::vector<ActivationFunction>& BasicQuantizedNet<T>::activations() const
+{
+    return m_activations;
+}
+
+template <typename T>
+size_t BasicQuantizedNet<T>::nInputs() const
+{
+    return m_layers.front();
+}
+
+template <typename T>
+size_t BasicQuantizedNet<T>::nOutputs() const
+{
+    return m_layers.back();
+}
+
+template <typename T>
+BasicMatrix<T> BasicQuantizedNet<T>::predict(const BasicMatrix<T>& x, const size_t n_threads) const
+{
+    if (x.nCol() != nInputs())
+        throw std::invalid_argument("Layer size mismatch!");
+
+    parallel::ThreadLimit thread_limit{ n_threads };
+    BasicMatrix<T> result{ x.nRow(), nOutputs(), std::vector<T>(x.nRow() * nOutputs()) };
+    parallel::forRange(x.nRow(), BLOCK_ROWS, [&](const size_t first, const size_t last) {
+        forward(x.data() + first * nInputs(), last - first, result.data() + first * nOutputs());
+    });
+    return result;
+}
+
+template <typename T>
+void BasicQuantizedNet<T>::predict(std::span<const T> x, std::span<T> out) const
+{
+    size_t n_rows{ x.size() / nInputs() };
+    if (x.size() % nInputs() != 0 || out.size() != n_rows * nOutputs())
+        throw std::invalid_argument("Input and output sizes do not match the network!");
+
+    forward(x.data(), n_rows, out.data());
+}
+
+template <typename T>
+void BasicQuantizedNet<T>::forward(const T* x, const size_t n_rows, T* out) const
+{
+    size_t widest{ *std::max_element(m_layers.begin(), m_layers.end()) };
+    //Grows once per thread to the widest network it has scored
+    thread_local std::vector<T> activations{};
+    thread_local std::vector<std::uint8_t> quantized{};
+    thread_local std::vector<std::int32_t> products{};
+    if (activations.size() < BLOCK_ROWS * widest)
+    {
+        activations.resize(BLOCK_ROWS * widest);
+        quantized.resize(BLOCK_ROWS * widest);
+        products.resize(widest);
+    }
+
+    //Blocks of rows share one activation call per layer, and keep the quantized inputs in cache
+    for (size_t first_row{ 0 }; first_row < n_rows; first_row += BLOCK_ROWS)
+    {
+        size_t n_block{ std::min(BLOCK_ROWS, n_rows - first_row) };
+        const T* input{ x + first_row * m_layers.front() };
+        for (size_t i{ 0 }; i < m_quantized.size(); i++)
+        {
+            const Layer& layer{ m_quantized[i] };
+            size_t n_in{ m_layers[i] };
+            size_t n_out{ m_layers[i + 1] };
+
+            //Clamped to [0, 255] before adding 0.5 and truncating, which rounds to nearest
+            for (size_t row{ 0 }; row < n_block; row++)
+            {
+                for (size_t col{ 0 }; col < n_in; col++)
+                {
+                    T shifted{ input[row * n_in + col] * layer.inverse_scales[col] + static_cast<T>(layer.zero_points[col]) };
+                    quantized[row * n_in + col] = static_cast<std::uint8_t>(std::clamp(shifted, T{ 0 }, T{ 255 }) + T{ 0.5 });
+                }
+            }
+
+            //The input is fully quantized by now, so hidden layers can write over it
+            T* output{ i + 1 == m_quantized.size() ? out + first_row * n_out : activations.data() };
+            for (size_t row{ 0 }; row < n_block; row++)
+            {
+                simd::matrixVectorU8I8(products.data(), quantized.data() + row * n_in, layer.weights.data(), n_out, n_in);
+                for (size_t col{ 0 }; col < n_out; col++)
+                {
+                    output[row * n_out + col] = static_cast<T>(products[col]) * layer.weight_scales[col] + layer.offsets[col];
+                }
+            }
+            m_activation_kernels[i].map(output, output, n_block * n_out);
+
+            input = output;
+        }
+    }
+}
+
+template class BasicQuantizedNet<float>;
+template class BasicQuantizedNet<double>;
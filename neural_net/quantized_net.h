@@ -0,0 +1,65 @@
+#pragma once
+#include "frozen_net.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+//Post-training int8 quantization of a frozen network, for inference.
+//Every layer's input is mapped to unsigned bytes, x ~ scale (q - zero_point), with one scale and zero point per input
+//column, taken from the range the float model produces on a set of calibration rows. The column scales are folded into
+//the weights, which are then rounded to signed bytes with one scale per output node. Products accumulate exactly in
+//32-bit integers (simd::matrixVectorU8I8) and are scaled back to T before the bias and the activation function.
+//Saved and loaded as its own model kind.
+template <typename T>
+class BasicQuantizedNet
+{
+private:
+    struct Layer
+    {
+        //One per input column
+        std::vector<T> input_scales{};
+        std::vector<std::uint8_t> zero_points{};
+        //n_out x n_in, one row per output node
+        std::vector<std::int8_t> weights{};
+        //One per output node
+        std::vector<T> weight_scales{};
+        std::vector<T> biases{};
+
+        //Derived by prepare(): the reciprocal input scales, and the biases with the zero point terms taken out
+        std::vector<T> inverse_scales{};
+        std::vector<T> offsets{};
+    };
+
+    static constexpr size_t BLOCK_ROWS{ 64 };
+
+    std::vector<size_t> m_layers{};
+    std::vector<ActivationFunction> m_activations{};
+    std::vector<ActivationKernels<T>> m_activation_kernels{};
+    std::vector<Layer> m_quantized{};
+
+    void prepare();
+    void forward(const T* x, const size_t n_rows, T* out) const;
+
+public:
+    //calibration_x holds raw feature rows like those the model will score
+    BasicQuantizedNet(const BasicFrozenNet<T>& model, const BasicMatrix<T>& calibration_x);
+    //Freezes the network first
+    BasicQuantizedNet(const BasicNeuralNet<T>& net, const BasicMatrix<T>& calibration_x);
+    BasicQuantizedNet(const std::string filename);
+
+    void save(const std::string filename) const;
+    void load(const std::string filename);
+
+    const std::vector<size_t>& layers() const;
+    const std::vector<ActivationFunction>& activations() const;
+    size_t nInputs() const;
+    size_t nOutputs() const;
+    BasicMatrix<T> predict(const BasicMatrix<T>& x, const size_t n_threads = 0) const;
+    //x holds whole rows of nInputs() raw features; out receives nOutputs() values per row.
+    //Scratch space is per thread and kept between calls, so this does not allocate once warm and may run concurrently.
+    void predict(std::span<const T> x, std::span<T> out) const;
+};
+
+using QuantizedNet = BasicQuantizedNet<double>;
+using FloatQuantizedNet = BasicQuantizedNet<float>;
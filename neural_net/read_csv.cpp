@@ -1,61 +1,386 @@
 #include "read_csv.h"
-#include <fstream>
+#include "mapped_file.h"
+#include "text_scan.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <charconv> // std::from_chars
+#include <cstring> // std::memchr
 #include <stdexcept> // std::runtime_error
-#include <sstream> // std::stringstream
+#include <utility>
 #include <iostream>
 #include <iomanip> // for output manipulator std::setprecision()
 
-data_frame read_csv(std::string filename)
+namespace
 {
-    std::ifstream myFile{ filename };
-    std::vector<std::string> colnames{};
-    std::vector<double> data{};
+    //Below this many bytes per thread a file is parsed on the calling thread
+    constexpr size_t MIN_CHUNK_BYTES{ 1 << 20 };
+    constexpr size_t SKIPPED{ static_cast<size_t>(-1) };
+
+    //A newline-aligned piece of the body, parsed by one task
+    struct Chunk
+    {
+        const char* begin{};
+        const char* end{};
+        size_t n_lines{};
+        size_t n_rows{};
+        //Line number of the chunk's first line in the file, counting the header as line 1
+        size_t first_line{};
+        size_t first_row{};
+        size_t error_line{};
+        std::string error{};
+    };
+
+    //Where the values of one column of the file go: a column of one of the output matrices, or nowhere.
+    //For a skipped column, col counts the skipped columns from it up to the next selected one or the end of the line.
+    struct Target
+    {
+        size_t output{ SKIPPED };
+        size_t col{};
+    };
+
+    void countSkippedRuns(std::vector<Target>& targets)
+    {
+        size_t run{ 0 };
+        for (size_t col{ targets.size() }; col-- > 0;)
+        {
+            run = targets[col].output == SKIPPED ? run + 1 : 0;
+            if (targets[col].output == SKIPPED)
+                targets[col].col = run;
+        }
+    }
+
+    struct Output
+    {
+        size_t n_cols{};
+        std::vector<double> data{};
+    };
+
+    const char* lineEnd(const char* begin, const char* end)
+    {
+        const void* newline{ std::memchr(begin, '\n', static_cast<size_t>(end - begin)) };
+        return newline ? static_cast<const char*>(newline) : end;
+    }
+
+    const char* skipSpaces(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        return p;
+    }
+
+    bool isBlank(const char* begin, const char* end)
+    {
+        return skipSpaces(begin, end) == end;
+    }
+
+    //Splits the first line into column names and returns where the body starts
+    const char* readHeader(const MappedFile& file, std::vector<std::string>& colnames)
+    {
+        const char* file_end{ file.data() + file.size() };
+        if (file.size() == 0)
+            return file_end;
+
+        const char* header_end{ lineEnd(file.data(), file_end) };
+        for (const char* name{ file.data() };;)
+        {
+            const char* name_end{ std::find(name, header_end, ',') };
+            colnames.emplace_back(name, name_end == header_end && name_end > name && name_end[-1] == '\r' ? name_end - 1 : name_end);
+            if (name_end == header_end)
+                break;
+            name = name_end + 1;
+        }
+        if (colnames.size() == 1 && colnames.front().empty())
+            colnames.clear();
+        return std::min(header_end + 1, file_end);
+    }
 
-    if (!myFile.is_open())
-        throw std::runtime_error("Could not open file");
+    //Parses one line holding exactly targets.size() fields into row of the outputs and returns what was wrong with it,
+    //or an empty string. Skipped fields are only scanned for the commas between them, never converted.
+    std::string parseRow(const char* p, const char* end, const size_t row, const std::vector<Target>& targets, std::vector<Output>& outputs)
+    {
+        size_t n_cols{ targets.size() };
+        for (size_t col{ 0 }; col < n_cols; col++)
+        {
+            const Target& target{ targets[col] };
+            if (target.output == SKIPPED)
+            {
+                //Passes over the whole run of skipped fields in one scan, stopping at the comma that ends the last of them
+                const char* run_begin{ p };
+                p = text_scan::findNth(p, end, ',', target.col);
+                if (p == end)
+                {
+                    size_t n_commas{ static_cast<size_t>(std::count(run_begin, end, ',')) };
+                    if (col + n_commas + 1 < n_cols)
+                        return "expected " + std::to_string(n_cols) + " columns, found " + std::to_string(col + n_commas + 1);
+                }
+                col += target.col - 1;
+            }
+            else
+            {
+                Output& output{ outputs[target.output] };
+                p = skipSpaces(p, end);
+                //from_chars takes no leading plus, stream extraction does
+                if (p < end && *p == '+')
+                    p++;
+                auto [next, ec]{ std::from_chars(p, end, output.data[row * output.n_cols + target.col]) };
+                if (ec == std::errc::result_out_of_range)
+                    return "column " + std::to_string(col + 1) + " is out of range";
+                if (ec != std::errc{})
+                    return "column " + std::to_string(col + 1) + " is not a number";
+                p = skipSpaces(next, end);
+            }
 
-    // Helper vars
-    std::string line{ "" };
-    std::string colname{ "" };
-    double val{ 0.0 };
+            if (col + 1 < n_cols)
+            {
+                if (p == end || *p != ',')
+                    return "expected " + std::to_string(n_cols) + " columns, found " + std::to_string(col + 1);
+                p++;
+            }
+        }
+        if (p != end)
+            return *p == ',' ? "more than " + std::to_string(n_cols) + " columns" : "unexpected text after column " + std::to_string(n_cols);
+        return {};
+    }
 
-    size_t n_cols{ 0 };
-    size_t n_rows{ 0 };
+    std::vector<size_t> resolveColumns(const std::vector<std::string>& colnames, const std::vector<CsvColumn>& selection)
+    {
+        std::vector<size_t> cols{};
+        for (const CsvColumn& column : selection)
+        {
+            cols.push_back(column.resolve(colnames));
+        }
+        return cols;
+    }
 
-    if (myFile.good())
+    //Targets sending the label columns to output 0 and the feature columns to output 1
+    std::vector<Target> selectColumns(const std::vector<std::string>& colnames, const std::vector<size_t>& label_cols, const std::vector<size_t>& feature_cols)
     {
-        // Extract the first line in the file
-        std::getline(myFile, line);
+        std::vector<Target> targets(colnames.size());
+        const std::vector<size_t>* selections[]{ &label_cols, &feature_cols };
+        for (size_t output{ 0 }; output < 2; output++)
+        {
+            for (size_t i{ 0 }; i < selections[output]->size(); i++)
+            {
+                size_t col{ (*selections[output])[i] };
+                if (targets[col].output != SKIPPED)
+                    throw std::invalid_argument("Column " + colnames[col] + " is selected more than once!");
+                targets[col] = Target{ output, i };
+            }
+        }
+        countSkippedRuns(targets);
+        return targets;
+    }
 
-        // Create a stringstream from line
-        std::stringstream ss{ line };
+    void countRows(Chunk& chunk)
+    {
+        for (const char* line{ chunk.begin }; line < chunk.end;)
+        {
+            const char* end{ lineEnd(line, chunk.end) };
+            chunk.n_lines++;
+            if (!isBlank(line, end))
+                chunk.n_rows++;
+            line = end + 1;
+        }
+    }
 
-        // Extract each column name
-        while (std::getline(ss, colname, ','))
+    void parseRows(Chunk& chunk, const std::vector<Target>& targets, std::vector<Output>& outputs)
+    {
+        size_t row{ chunk.first_row };
+        size_t line_number{ chunk.first_line };
+        for (const char* line{ chunk.begin }; line < chunk.end; line_number++)
         {
-            n_cols++;
-            colnames.push_back(colname);
+            const char* end{ lineEnd(line, chunk.end) };
+            if (!isBlank(line, end))
+            {
+                chunk.error = parseRow(line, end, row, targets, outputs);
+                if (!chunk.error.empty())
+                {
+                    chunk.error_line = line_number;
+                    return;
+                }
+                row++;
+            }
+            line = end + 1;
         }
     }
 
-    // Read data, line by line
-    while (std::getline(myFile, line))
+    //Parses the whole lines in [body, file_end), the first of which is line first_line of the file.
+    //The range is split into newline-aligned chunks, one per thread. A first parallel pass counts the rows of every
+    //chunk, which gives each chunk its offset in the outputs; the second pass parses the chunks straight into place.
+    //Returns the number of rows.
+    size_t readBody(const char* body, const char* file_end, const size_t first_line, const std::string& filename, const std::vector<Target>& targets, std::vector<Output>& outputs)
     {
-        // Create a stringstream of the current line
-        std::stringstream ss{ line };
-        n_rows++;
-        // Keep track of the current column index
-        while (ss >> val)
+        size_t body_size{ static_cast<size_t>(file_end - body) };
+        size_t n_chunks{ std::clamp<size_t>(body_size / MIN_CHUNK_BYTES, 1, parallel::numThreads()) };
+        std::vector<Chunk> chunks(n_chunks);
+        const char* chunk_begin{ body };
+        for (size_t i{ 0 }; i < n_chunks; i++)
+        {
+            const char* chunk_end{ file_end };
+            if (i + 1 < n_chunks)
+                chunk_end = std::min(lineEnd(std::max(chunk_begin, body + body_size * (i + 1) / n_chunks), file_end) + 1, file_end);
+            chunks[i].begin = chunk_begin;
+            chunks[i].end = chunk_end;
+            chunk_begin = chunk_end;
+        }
+
+        parallel::forRange(n_chunks, 1, [&](const size_t first, const size_t last) {
+            for (size_t i{ first }; i < last; i++)
+                countRows(chunks[i]);
+        });
+
+        size_t n_rows{ 0 };
+        size_t line_number{ first_line };
+        for (Chunk& chunk : chunks)
+        {
+            chunk.first_row = n_rows;
+            chunk.first_line = line_number;
+            n_rows += chunk.n_rows;
+            line_number += chunk.n_lines;
+        }
+
+        for (Output& output : outputs)
+        {
+            output.data.resize(n_rows * output.n_cols);
+        }
+        parallel::forRange(n_chunks, 1, [&](const size_t first, const size_t last) {
+            for (size_t i{ first }; i < last; i++)
+                parseRows(chunks[i], targets, outputs);
+        });
+
+        // Chunks are in file order, so the first one with an error holds the earliest bad line
+        for (const Chunk& chunk : chunks)
         {
-            // Add the current integer to the 'colIdx' column's values vector
-            data.push_back(val);
-            // If the next token is a comma, ignore it and move on
-            if (ss.peek() == ',') 
-                ss.ignore();
+            if (!chunk.error.empty())
+                throw std::runtime_error("Malformed row on line " + std::to_string(chunk.error_line) + " of " + filename + ": " + chunk.error);
         }
+        return n_rows;
     }
+}
+
+CsvColumn::CsvColumn(std::string name)
+    : m_column{ std::move(name) }
+{
+}
+
+CsvColumn::CsvColumn(const char* name)
+    : m_column{ std::string{ name } }
+{
+}
+
+size_t CsvColumn::resolve(const std::vector<std::string>& colnames) const
+{
+    if (const size_t* index{ std::get_if<size_t>(&m_column) })
+    {
+        if (*index >= colnames.size())
+            throw std::invalid_argument("Column " + std::to_string(*index) + " is out of range!");
+        return *index;
+    }
+
+    const std::string& name{ std::get<std::string>(m_column) };
+    auto it{ std::find(colnames.begin(), colnames.end(), name) };
+    if (it == colnames.end())
+        throw std::invalid_argument("No column named " + name + "!");
+    return static_cast<size_t>(it - colnames.begin());
+}
+
+data_frame read_csv(std::string filename)
+{
+    MappedFile file{ filename };
+    std::vector<std::string> colnames{};
+    const char* body{ readHeader(file, colnames) };
+
+    std::vector<Target> targets(colnames.size());
+    for (size_t col{ 0 }; col < targets.size(); col++)
+    {
+        targets[col] = Target{ 0, col };
+    }
+    std::vector<Output> outputs{ Output{ colnames.size() } };
+    size_t n_rows{ readBody(body, file.data() + file.size(), 2, filename, targets, outputs) };
+
+    return std::pair{ colnames, Matrix{ n_rows, colnames.size(), std::move(outputs[0].data) } };
+}
+
+labeled_data read_csv(std::string filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols)
+{
+    MappedFile file{ filename };
+    std::vector<std::string> colnames{};
+    const char* body{ readHeader(file, colnames) };
+
+    std::vector<Target> targets{ selectColumns(colnames, resolveColumns(colnames, label_cols), resolveColumns(colnames, feature_cols)) };
+    std::vector<Output> outputs{ Output{ label_cols.size() }, Output{ feature_cols.size() } };
+    size_t n_rows{ readBody(body, file.data() + file.size(), 2, filename, targets, outputs) };
+
+    return labeled_data{ Matrix{ n_rows, label_cols.size(), std::move(outputs[0].data) }, Matrix{ n_rows, feature_cols.size(), std::move(outputs[1].data) } };
+}
+
+CsvChunkReader::CsvChunkReader(std::string filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols, const size_t chunk_bytes)
+    : m_filename{ std::move(filename) }, m_file{ m_filename }
+{
+    if (chunk_bytes == 0)
+        throw std::invalid_argument("Chunk size must be positive!");
+
+    const char* body{ readHeader(m_file, m_colnames) };
+    m_label_cols = resolveColumns(m_colnames, label_cols);
+    m_feature_cols = resolveColumns(m_colnames, feature_cols);
+    selectColumns(m_colnames, m_label_cols, m_feature_cols);
+
+    const char* file_end{ m_file.data() + m_file.size() };
+    std::vector<Chunk> chunks{};
+    for (const char* chunk_begin{ body }; chunk_begin < file_end;)
+    {
+        const char* chunk_end{ file_end };
+        if (static_cast<size_t>(file_end - chunk_begin) > chunk_bytes)
+            chunk_end = std::min(lineEnd(chunk_begin + chunk_bytes, file_end) + 1, file_end);
+        chunks.push_back(Chunk{ chunk_begin, chunk_end });
+        chunk_begin = chunk_end;
+    }
+
+    parallel::forRange(chunks.size(), 1, [&](const size_t first, const size_t last) {
+        for (size_t i{ first }; i < last; i++)
+            countRows(chunks[i]);
+    });
+
+    size_t line_number{ 2 };
+    for (const Chunk& chunk : chunks)
+    {
+        //A chunk of nothing but blank lines has no rows to hand out
+        if (chunk.n_rows > 0)
+            m_chunks.push_back(ChunkSpan{ chunk.begin, chunk.end, chunk.n_rows, line_number });
+        m_n_rows += chunk.n_rows;
+        line_number += chunk.n_lines;
+    }
+}
+
+size_t CsvChunkReader::nChunks() const
+{
+    return m_chunks.size();
+}
+
+size_t CsvChunkReader::nRows() const
+{
+    return m_n_rows;
+}
+
+size_t CsvChunkReader::nLabels() const
+{
+    return m_label_cols.size();
+}
+
+size_t CsvChunkReader::nFeatures() const
+{
+    return m_feature_cols.size();
+}
+
+void CsvChunkReader::readChunk(const size_t chunk, Matrix& y, Matrix& x) const
+{
+    const ChunkSpan& span{ m_chunks.at(chunk) };
+    std::vector<Target> targets{ selectColumns(m_colnames, m_label_cols, m_feature_cols) };
+    std::vector<Output> outputs{ Output{ m_label_cols.size() }, Output{ m_feature_cols.size() } };
+    size_t n_rows{ readBody(span.begin, span.end, span.first_line, m_filename, targets, outputs) };
 
-    return std::pair{ colnames, Matrix{ n_rows, n_cols, data } };
+    y = Matrix{ n_rows, m_label_cols.size(), std::move(outputs[0].data) };
+    x = Matrix{ n_rows, m_feature_cols.size(), std::move(outputs[1].data) };
 }
 
 void print_data_frame(data_frame print_me, std::ostream& stream)
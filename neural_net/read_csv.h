@@ -1,10 +1,78 @@
 #pragma once
+#include <concepts>
 #include <string>
 #include <utility> // std::pair
+#include <variant>
 #include <vector>
+#include "mapped_file.h"
 #include "matrix.h"
 
 using data_frame = std::pair<std::vector<std::string>, Matrix>;
 
+//Label and feature columns read straight out of a file, one row per line
+struct labeled_data
+{
+    Matrix y{};
+    Matrix x{};
+};
+
+//A column picked by its zero-based position or by its name in the header
+class CsvColumn
+{
+private:
+    std::variant<size_t, std::string> m_column;
+
+public:
+    template <std::integral I>
+    CsvColumn(const I index)
+        : m_column{ static_cast<size_t>(index) }
+    {
+    }
+    CsvColumn(std::string name);
+    CsvColumn(const char* name);
+
+    //Position of the column in colnames; throws std::invalid_argument if there is none
+    size_t resolve(const std::vector<std::string>& colnames) const;
+};
+
+//Reads a comma-separated file whose first line names the columns and whose other lines hold one number each.
+//The file is memory-mapped and parsed with std::from_chars on up to parallel::numThreads() threads.
+//Blank lines are skipped; any other line without exactly one number per column throws std::runtime_error naming its line.
 data_frame read_csv(std::string filename);
+//Reads only the selected columns, in the order given, into y and x; the other fields are checked for count but never
+//converted, so neither their parse time nor the full table's memory is paid. A column may be selected only once.
+labeled_data read_csv(std::string filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols);
+
+//A CSV file read one chunk of rows at a time, for files larger than memory. The file stays memory-mapped, so only
+//the chunk being parsed takes process memory. Construction splits the body into newline-aligned chunks of about
+//chunk_bytes and counts their rows in parallel; readChunk parses one, with columns selected as in read_csv.
+class CsvChunkReader
+{
+private:
+    struct ChunkSpan
+    {
+        const char* begin{};
+        const char* end{};
+        size_t n_rows{};
+        size_t first_line{};
+    };
+
+    std::string m_filename;
+    MappedFile m_file;
+    std::vector<std::string> m_colnames{};
+    std::vector<size_t> m_label_cols{};
+    std::vector<size_t> m_feature_cols{};
+    std::vector<ChunkSpan> m_chunks{};
+    size_t m_n_rows{};
+
+public:
+    CsvChunkReader(std::string filename, const std::vector<CsvColumn>& label_cols, const std::vector<CsvColumn>& feature_cols, const size_t chunk_bytes);
+
+    size_t nChunks() const;
+    size_t nRows() const;
+    size_t nLabels() const;
+    size_t nFeatures() const;
+    void readChunk(const size_t chunk, Matrix& y, Matrix& x) const;
+};
+
 void print_data_frame(data_frame print_me, std::ostream& stream = std::cout);
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "rng.h"
 #include <stdexcept>
+#include <algorithm>
 
 RNG::RNG()
 {
@@ -8,6 +9,16 @@ RNG::RNG()
     m_randomEngine = std::default_random_engine{ m_seed };
 }
 
+RNG::RNG(const unsigned int seed)
+    : m_seed{ seed }, m_randomEngine{ seed }
+{
+}
+
+unsigned int RNG::seed() const
+{
+    return m_seed;
+}
+
 void RNG::shuffleVector(std::vector<double>& shuffle_me)
 {
     std::shuffle(shuffle_me.begin(), shuffle_me.end(), m_randomEngine);
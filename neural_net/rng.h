@@ -8,7 +8,12 @@ private:
     std::default_random_engine m_randomEngine{};
 
 public:
+    //Seeds from std::random_device
     RNG();
+    //Seeds deterministically, so the same seed repeats the same sequence
+    explicit RNG(const unsigned int seed);
+
+    unsigned int seed() const;
 
     void shuffleVector(std::vector<double>& shuffle_me);
     void shuffleVector(std::vector<int>& shuffle_me);
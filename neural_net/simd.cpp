@@ -0,0 +1,1302 @@
+#include "simd.h"
+#include "simd_constants.h"
+#include "text_scan.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//MSVC accepts any intrinsic in any function, GCC and Clang need the target enabled per function
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_AVX512
+#define SIMD_TARGET_AVX512_VNNI
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+#define SIMD_TARGET_AVX512_VNNI __attribute__((target("avx512f,avx512bw,avx512vnni")))
+#endif
+
+namespace
+{
+    //Element-wise maps at one simd::Accuracy
+    template <typename T>
+    struct Transcendentals
+    {
+        void (*exp)(T*, const T*, const size_t);
+        void (*tanh)(T*, const T*, const size_t);
+        void (*sigmoid)(T*, const T*, const size_t);
+        void (*softplus)(T*, const T*, const size_t);
+        void (*softplusWithDer)(T*, T*, const T*, const size_t);
+    };
+
+    template <typename T>
+    struct Kernels
+    {
+        void (*add)(T*, const T*, const T*, const size_t);
+        void (*subtract)(T*, const T*, const T*, const size_t);
+        void (*multiply)(T*, const T*, const T*, const size_t);
+        void (*scale)(T*, const T*, const T, const size_t);
+        void (*addScalar)(T*, const T*, const T, const size_t);
+        T (*dot)(const T*, const T*, const size_t);
+        T (*sum)(const T*, const size_t);
+        Transcendentals<T> accurate;
+        Transcendentals<T> fast;
+    };
+
+    //Each instruction set provides one table per precision
+    struct KernelSet
+    {
+        Kernels<float> f32;
+        Kernels<double> f64;
+        void (*matrixVectorU8I8)(std::int32_t*, const std::uint8_t*, const std::int8_t*, const size_t, const size_t);
+        const char* (*findNth)(const char*, const char*, const char, const size_t);
+    };
+
+    template <typename T>
+    const Kernels<T>& select(const KernelSet& kernel_set)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return kernel_set.f32;
+        else
+            return kernel_set.f64;
+    }
+
+    //Sequential reductions used in strict mode, identical to a plain accumulate loop
+    template <typename T>
+    T strictDot(const T* a, const T* b, const size_t n)
+    {
+        T result{ 0 };
+        for (size_t i{ 0 }; i < n; i++)
+        {
+            result += a[i] * b[i];
+        }
+        return result;
+    }
+
+    template <typename T>
+    T strictSum(const T* a, const size_t n)
+    {
+        T result{ 0 };
+        for (size_t i{ 0 }; i < n; i++)
+        {
+            result += a[i];
+        }
+        return result;
+    }
+
+    namespace scalar_impl
+    {
+        template <typename T>
+        void add(T* dst, const T* a, const T* b, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = a[i] + b[i];
+            }
+        }
+
+        template <typename T>
+        void subtract(T* dst, const T* a, const T* b, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = a[i] - b[i];
+            }
+        }
+
+        template <typename T>
+        void multiply(T* dst, const T* a, const T* b, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = a[i] * b[i];
+            }
+        }
+
+        template <typename T>
+        void scale(T* dst, const T* a, const T multiplier, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = a[i] * multiplier;
+            }
+        }
+
+        template <typename T>
+        void addScalar(T* dst, const T* a, const T add_me, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = a[i] + add_me;
+            }
+        }
+
+        //Four independent accumulators break the dependency chain of the sequential sum
+        template <typename T>
+        T dot(const T* a, const T* b, const size_t n)
+        {
+            T acc[4]{};
+            size_t i{ 0 };
+            for (; i + 4 <= n; i += 4)
+            {
+                acc[0] += a[i] * b[i];
+                acc[1] += a[i + 1] * b[i + 1];
+                acc[2] += a[i + 2] * b[i + 2];
+                acc[3] += a[i + 3] * b[i + 3];
+            }
+            T result{ (acc[0] + acc[1]) + (acc[2] + acc[3]) };
+            for (; i < n; i++)
+            {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        template <typename T>
+        T sum(const T* a, const size_t n)
+        {
+            T acc[4]{};
+            size_t i{ 0 };
+            for (; i + 4 <= n; i += 4)
+            {
+                acc[0] += a[i];
+                acc[1] += a[i + 1];
+                acc[2] += a[i + 2];
+                acc[3] += a[i + 3];
+            }
+            T result{ (acc[0] + acc[1]) + (acc[2] + acc[3]) };
+            for (; i < n; i++)
+            {
+                result += a[i];
+            }
+            return result;
+        }
+
+        //The portable fallback leaves both accuracies to libm
+        template <typename T>
+        void exp(T* dst, const T* a, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = std::exp(a[i]);
+            }
+        }
+
+        template <typename T>
+        void tanh(T* dst, const T* a, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = std::tanh(a[i]);
+            }
+        }
+
+        template <typename T>
+        void sigmoid(T* dst, const T* a, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = T{ 1 } / (T{ 1 } + std::exp(-a[i]));
+            }
+        }
+
+        template <typename T>
+        void softplus(T* dst, const T* a, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                dst[i] = std::max(a[i], T{ 0 }) + std::log1p(std::exp(-std::abs(a[i])));
+            }
+        }
+
+        template <typename T>
+        void softplusWithDer(T* dst, T* dst_der, const T* a, const size_t n)
+        {
+            for (size_t i{ 0 }; i < n; i++)
+            {
+                T x{ a[i] };
+                T e{ std::exp(-std::abs(x)) };
+                dst[i] = std::max(x, T{ 0 }) + std::log1p(e);
+                dst_der[i] = x < 0 ? e / (T{ 1 } + e) : T{ 1 } / (T{ 1 } + e);
+            }
+        }
+
+        template <typename T>
+        constexpr Transcendentals<T> transcendentals{ exp<T>, tanh<T>, sigmoid<T>, softplus<T>, softplusWithDer<T> };
+
+        void matrixVectorU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_rows, const size_t n_cols)
+        {
+            for (size_t row{ 0 }; row < n_rows; row++)
+            {
+                std::int32_t result{ 0 };
+                for (size_t col{ 0 }; col < n_cols; col++)
+                {
+                    result += static_cast<std::int32_t>(x[col]) * static_cast<std::int32_t>(w[row * n_cols + col]);
+                }
+                dst[row] = result;
+            }
+        }
+
+        const char* findNth(const char* begin, const char* end, const char c, size_t n)
+        {
+            if (n == 0)
+                return begin;
+            while (const void* found{ std::memchr(begin, c, static_cast<size_t>(end - begin)) })
+            {
+                if (--n == 0)
+                    return static_cast<const char*>(found);
+                begin = static_cast<const char*>(found) + 1;
+            }
+            return end;
+        }
+
+        constexpr KernelSet kernels{
+            { add<float>, subtract<float>, multiply<float>, scale<float>, addScalar<float>, dot<float>, sum<float>, transcendentals<float>, transcendentals<float> },
+            { add<double>, subtract<double>, multiply<double>, scale<double>, addScalar<double>, dot<double>, sum<double>, transcendentals<double>, transcendentals<double> },
+            matrixVectorU8I8,
+            findNth
+        };
+    }
+
+#ifdef SIMD_X86
+    //Shared with header_export, whose generated headers repeat the accurate approximations
+    using simd::MathConstants;
+
+    //Offset of the n-th set bit of mask, counting from 1, for the vector versions of findNth; mask holds at least n
+    unsigned int nthSetBit(std::uint64_t mask, size_t n)
+    {
+        for (; n > 1; n--)
+        {
+            mask &= mask - 1;
+        }
+        return static_cast<unsigned int>(std::countr_zero(mask));
+    }
+
+    //Every instruction set wraps its intrinsics in one traits struct per precision;
+    //the kernels below are written once against that interface
+    namespace sse2_impl
+    {
+        struct F64
+        {
+            using Scalar = double;
+            using Vector = __m128d;
+            using Mask = __m128d;
+            static constexpr size_t width{ 2 };
+
+            static Vector load(const double* p) { return _mm_loadu_pd(p); }
+            static void store(double* p, const Vector x) { _mm_storeu_pd(p, x); }
+            static Vector set1(const double x) { return _mm_set1_pd(x); }
+            static Vector zero() { return _mm_setzero_pd(); }
+            static Vector add(const Vector a, const Vector b) { return _mm_add_pd(a, b); }
+            static Vector sub(const Vector a, const Vector b) { return _mm_sub_pd(a, b); }
+            static Vector mul(const Vector a, const Vector b) { return _mm_mul_pd(a, b); }
+            static Vector fmadd(const Vector a, const Vector b, const Vector acc) { return _mm_add_pd(acc, _mm_mul_pd(a, b)); }
+            static Vector div(const Vector a, const Vector b) { return _mm_div_pd(a, b); }
+            static Vector min(const Vector a, const Vector b) { return _mm_min_pd(a, b); }
+            static Vector max(const Vector a, const Vector b) { return _mm_max_pd(a, b); }
+            static Vector abs(const Vector x) { return _mm_andnot_pd(_mm_set1_pd(-0.0), x); }
+            static Vector copySign(const Vector magnitude, const Vector sign) { return _mm_or_pd(abs(magnitude), _mm_and_pd(_mm_set1_pd(-0.0), sign)); }
+            static Mask less(const Vector a, const Vector b) { return _mm_cmplt_pd(a, b); }
+            static Mask isNan(const Vector x) { return _mm_cmpunord_pd(x, x); }
+            static Vector blend(const Mask mask, const Vector if_true, const Vector if_false) { return _mm_or_pd(_mm_and_pd(mask, if_true), _mm_andnot_pd(mask, if_false)); }
+            //Adds the integer held in the low mantissa bits of n to the exponent of x
+            static Vector scaleByPow2(const Vector x, const Vector n) { return _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(x), _mm_slli_epi64(_mm_castpd_si128(n), 52))); }
+
+            static double horizontalSum(const Vector x)
+            {
+                return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+            }
+        };
+
+        struct F32
+        {
+            using Scalar = float;
+            using Vector = __m128;
+            using Mask = __m128;
+            static constexpr size_t width{ 4 };
+
+            static Vector load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, const Vector x) { _mm_storeu_ps(p, x); }
+            static Vector set1(const float x) { return _mm_set1_ps(x); }
+            static Vector zero() { return _mm_setzero_ps(); }
+            static Vector add(const Vector a, const Vector b) { return _mm_add_ps(a, b); }
+            static Vector sub(const Vector a, const Vector b) { return _mm_sub_ps(a, b); }
+            static Vector mul(const Vector a, const Vector b) { return _mm_mul_ps(a, b); }
+            static Vector fmadd(const Vector a, const Vector b, const Vector acc) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+            static Vector div(const Vector a, const Vector b) { return _mm_div_ps(a, b); }
+            static Vector min(const Vector a, const Vector b) { return _mm_min_ps(a, b); }
+            static Vector max(const Vector a, const Vector b) { return _mm_max_ps(a, b); }
+            static Vector abs(const Vector x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+            static Vector copySign(const Vector magnitude, const Vector sign) { return _mm_or_ps(abs(magnitude), _mm_and_ps(_mm_set1_ps(-0.0f), sign)); }
+            static Mask less(const Vector a, const Vector b) { return _mm_cmplt_ps(a, b); }
+            static Mask isNan(const Vector x) { return _mm_cmpunord_ps(x, x); }
+            static Vector blend(const Mask mask, const Vector if_true, const Vector if_false) { return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false)); }
+            static Vector scaleByPow2(const Vector x, const Vector n) { return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(x), _mm_slli_epi32(_mm_castps_si128(n), 23))); }
+
+            static float horizontalSum(const Vector x)
+            {
+                __m128 pairs{ _mm_add_ps(x, _mm_movehl_ps(x, x)) };
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+        };
+
+        template <typename V, typename T = typename V::Scalar>
+        void add(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::add(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] + b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        void subtract(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::sub(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] - b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        void multiply(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::mul(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] * b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        void scale(T* dst, const T* a, const T multiplier, const size_t n)
+        {
+            typename V::Vector m{ V::set1(multiplier) };
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::mul(V::load(a + i), m));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] * multiplier;
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        void addScalar(T* dst, const T* a, const T add_me, const size_t n)
+        {
+            typename V::Vector s{ V::set1(add_me) };
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::add(V::load(a + i), s));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] + add_me;
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        T dot(const T* a, const T* b, const size_t n)
+        {
+            constexpr size_t w{ V::width };
+            typename V::Vector acc0{ V::zero() };
+            typename V::Vector acc1{ V::zero() };
+            typename V::Vector acc2{ V::zero() };
+            typename V::Vector acc3{ V::zero() };
+            size_t i{ 0 };
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);
+                acc1 = V::fmadd(V::load(a + i + w), V::load(b + i + w), acc1);
+                acc2 = V::fmadd(V::load(a + i + 2 * w), V::load(b + i + 2 * w), acc2);
+                acc3 = V::fmadd(V::load(a + i + 3 * w), V::load(b + i + 3 * w), acc3);
+            }
+            for (; i + w <= n; i += w)
+            {
+                acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);
+            }
+            T result{ V::horizontalSum(V::add(V::add(acc0, acc1), V::add(acc2, acc3))) };
+            for (; i < n; i++)
+            {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        T sum(const T* a, const size_t n)
+        {
+            constexpr size_t w{ V::width };
+            typename V::Vector acc0{ V::zero() };
+            typename V::Vector acc1{ V::zero() };
+            typename V::Vector acc2{ V::zero() };
+            typename V::Vector acc3{ V::zero() };
+            size_t i{ 0 };
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                acc0 = V::add(acc0, V::load(a + i));
+                acc1 = V::add(acc1, V::load(a + i + w));
+                acc2 = V::add(acc2, V::load(a + i + 2 * w));
+                acc3 = V::add(acc3, V::load(a + i + 3 * w));
+            }
+            for (; i + w <= n; i += w)
+            {
+                acc0 = V::add(acc0, V::load(a + i));
+            }
+            T result{ V::horizontalSum(V::add(V::add(acc0, acc1), V::add(acc2, acc3))) };
+            for (; i < n; i++)
+            {
+                result += a[i];
+            }
+            return result;
+        }
+
+        //Counts matches a whole block at a time and only locates the one asked for
+        const char* findNth(const char* begin, const char* end, const char c, size_t n)
+        {
+            if (n == 0)
+                return begin;
+            __m128i target{ _mm_set1_epi8(c) };
+            for (; end - begin >= 16; begin += 16)
+            {
+                unsigned int mask{ static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)), target))) };
+                size_t count{ static_cast<size_t>(std::popcount(mask)) };
+                if (count >= n)
+                    return begin + nthSetBit(mask, n);
+                n -= count;
+            }
+            return scalar_impl::findNth(begin, end, c, n);
+        }
+
+#define SIMD_TARGET
+#include "simd_math.inl"
+#undef SIMD_TARGET
+
+        constexpr KernelSet kernels{
+            { add<F32>, subtract<F32>, multiply<F32>, scale<F32>, addScalar<F32>, dot<F32>, sum<F32>,
+                transcendentals<F32, simd::Accuracy::accurate>, transcendentals<F32, simd::Accuracy::fast> },
+            { add<F64>, subtract<F64>, multiply<F64>, scale<F64>, addScalar<F64>, dot<F64>, sum<F64>,
+                transcendentals<F64, simd::Accuracy::accurate>, transcendentals<F64, simd::Accuracy::fast> },
+            //The integer kernel has no SSE2 version; the scalar loop is what the compiler vectorizes for SSE2 anyway
+            scalar_impl::matrixVectorU8I8,
+            findNth
+        };
+    }
+
+    namespace avx2_impl
+    {
+        struct F64
+        {
+            using Scalar = double;
+            using Vector = __m256d;
+            using Mask = __m256d;
+            static constexpr size_t width{ 4 };
+
+            SIMD_TARGET_AVX2 static Vector load(const double* p) { return _mm256_loadu_pd(p); }
+            SIMD_TARGET_AVX2 static void store(double* p, const Vector x) { _mm256_storeu_pd(p, x); }
+            SIMD_TARGET_AVX2 static Vector set1(const double x) { return _mm256_set1_pd(x); }
+            SIMD_TARGET_AVX2 static Vector zero() { return _mm256_setzero_pd(); }
+            SIMD_TARGET_AVX2 static Vector add(const Vector a, const Vector b) { return _mm256_add_pd(a, b); }
+            SIMD_TARGET_AVX2 static Vector sub(const Vector a, const Vector b) { return _mm256_sub_pd(a, b); }
+            SIMD_TARGET_AVX2 static Vector mul(const Vector a, const Vector b) { return _mm256_mul_pd(a, b); }
+            SIMD_TARGET_AVX2 static Vector fmadd(const Vector a, const Vector b, const Vector acc) { return _mm256_fmadd_pd(a, b, acc); }
+            SIMD_TARGET_AVX2 static Vector div(const Vector a, const Vector b) { return _mm256_div_pd(a, b); }
+            SIMD_TARGET_AVX2 static Vector min(const Vector a, const Vector b) { return _mm256_min_pd(a, b); }
+            SIMD_TARGET_AVX2 static Vector max(const Vector a, const Vector b) { return _mm256_max_pd(a, b); }
+            SIMD_TARGET_AVX2 static Vector abs(const Vector x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+            SIMD_TARGET_AVX2 static Vector copySign(const Vector magnitude, const Vector sign) { return _mm256_or_pd(abs(magnitude), _mm256_and_pd(_mm256_set1_pd(-0.0), sign)); }
+            SIMD_TARGET_AVX2 static Mask less(const Vector a, const Vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+            SIMD_TARGET_AVX2 static Mask isNan(const Vector x) { return _mm256_cmp_pd(x, x, _CMP_UNORD_Q); }
+            SIMD_TARGET_AVX2 static Vector blend(const Mask mask, const Vector if_true, const Vector if_false) { return _mm256_blendv_pd(if_false, if_true, mask); }
+            SIMD_TARGET_AVX2 static Vector scaleByPow2(const Vector x, const Vector n) { return _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(x), _mm256_slli_epi64(_mm256_castpd_si256(n), 52))); }
+
+            SIMD_TARGET_AVX2 static double horizontalSum(const Vector x)
+            {
+                __m128d half{ _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1)) };
+                return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+            }
+        };
+
+        struct F32
+        {
+            using Scalar = float;
+            using Vector = __m256;
+            using Mask = __m256;
+            static constexpr size_t width{ 8 };
+
+            SIMD_TARGET_AVX2 static Vector load(const float* p) { return _mm256_loadu_ps(p); }
+            SIMD_TARGET_AVX2 static void store(float* p, const Vector x) { _mm256_storeu_ps(p, x); }
+            SIMD_TARGET_AVX2 static Vector set1(const float x) { return _mm256_set1_ps(x); }
+            SIMD_TARGET_AVX2 static Vector zero() { return _mm256_setzero_ps(); }
+            SIMD_TARGET_AVX2 static Vector add(const Vector a, const Vector b) { return _mm256_add_ps(a, b); }
+            SIMD_TARGET_AVX2 static Vector sub(const Vector a, const Vector b) { return _mm256_sub_ps(a, b); }
+            SIMD_TARGET_AVX2 static Vector mul(const Vector a, const Vector b) { return _mm256_mul_ps(a, b); }
+            SIMD_TARGET_AVX2 static Vector fmadd(const Vector a, const Vector b, const Vector acc) { return _mm256_fmadd_ps(a, b, acc); }
+            SIMD_TARGET_AVX2 static Vector div(const Vector a, const Vector b) { return _mm256_div_ps(a, b); }
+            SIMD_TARGET_AVX2 static Vector min(const Vector a, const Vector b) { return _mm256_min_ps(a, b); }
+            SIMD_TARGET_AVX2 static Vector max(const Vector a, const Vector b) { return _mm256_max_ps(a, b); }
+            SIMD_TARGET_AVX2 static Vector abs(const Vector x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x); }
+            SIMD_TARGET_AVX2 static Vector copySign(const Vector magnitude, const Vector sign) { return _mm256_or_ps(abs(magnitude), _mm256_and_ps(_mm256_set1_ps(-0.0f), sign)); }
+            SIMD_TARGET_AVX2 static Mask less(const Vector a, const Vector b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            SIMD_TARGET_AVX2 static Mask isNan(const Vector x) { return _mm256_cmp_ps(x, x, _CMP_UNORD_Q); }
+            SIMD_TARGET_AVX2 static Vector blend(const Mask mask, const Vector if_true, const Vector if_false) { return _mm256_blendv_ps(if_false, if_true, mask); }
+            SIMD_TARGET_AVX2 static Vector scaleByPow2(const Vector x, const Vector n) { return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(x), _mm256_slli_epi32(_mm256_castps_si256(n), 23))); }
+
+            SIMD_TARGET_AVX2 static float horizontalSum(const Vector x)
+            {
+                __m128 half{ _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1)) };
+                __m128 pairs{ _mm_add_ps(half, _mm_movehl_ps(half, half)) };
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+        };
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 void add(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::add(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] + b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 void subtract(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::sub(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] - b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 void multiply(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::mul(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] * b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 void scale(T* dst, const T* a, const T multiplier, const size_t n)
+        {
+            typename V::Vector m{ V::set1(multiplier) };
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::mul(V::load(a + i), m));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] * multiplier;
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 void addScalar(T* dst, const T* a, const T add_me, const size_t n)
+        {
+            typename V::Vector s{ V::set1(add_me) };
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::add(V::load(a + i), s));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] + add_me;
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 T dot(const T* a, const T* b, const size_t n)
+        {
+            constexpr size_t w{ V::width };
+            typename V::Vector acc0{ V::zero() };
+            typename V::Vector acc1{ V::zero() };
+            typename V::Vector acc2{ V::zero() };
+            typename V::Vector acc3{ V::zero() };
+            size_t i{ 0 };
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);
+                acc1 = V::fmadd(V::load(a + i + w), V::load(b + i + w), acc1);
+                acc2 = V::fmadd(V::load(a + i + 2 * w), V::load(b + i + 2 * w), acc2);
+                acc3 = V::fmadd(V::load(a + i + 3 * w), V::load(b + i + 3 * w), acc3);
+            }
+            for (; i + w <= n; i += w)
+            {
+                acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);
+            }
+            T result{ V::horizontalSum(V::add(V::add(acc0, acc1), V::add(acc2, acc3))) };
+            for (; i < n; i++)
+            {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX2 T sum(const T* a, const size_t n)
+        {
+            constexpr size_t w{ V::width };
+            typename V::Vector acc0{ V::zero() };
+            typename V::Vector acc1{ V::zero() };
+            typename V::Vector acc2{ V::zero() };
+            typename V::Vector acc3{ V::zero() };
+            size_t i{ 0 };
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                acc0 = V::add(acc0, V::load(a + i));
+                acc1 = V::add(acc1, V::load(a + i + w));
+                acc2 = V::add(acc2, V::load(a + i + 2 * w));
+                acc3 = V::add(acc3, V::load(a + i + 3 * w));
+            }
+            for (; i + w <= n; i += w)
+            {
+                acc0 = V::add(acc0, V::load(a + i));
+            }
+            T result{ V::horizontalSum(V::add(V::add(acc0, acc1), V::add(acc2, acc3))) };
+            for (; i < n; i++)
+            {
+                result += a[i];
+            }
+            return result;
+        }
+
+        //R rows of w against the same x, so every load of x is shared. Both operands are widened to 16 bits before
+        //vpmaddwd; the 8-bit vpmaddubsw would saturate its 16-bit pair sums
+        template <size_t R>
+        SIMD_TARGET_AVX2 void dotRowsU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_cols)
+        {
+            __m256i acc[R]{};
+            size_t col{ 0 };
+            for (; col + 16 <= n_cols; col += 16)
+            {
+                __m256i x_wide{ _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + col))) };
+                for (size_t r{ 0 }; r < R; r++)
+                {
+                    __m256i w_wide{ _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + r * n_cols + col))) };
+                    acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(x_wide, w_wide));
+                }
+            }
+            for (size_t r{ 0 }; r < R; r++)
+            {
+                __m128i half{ _mm_add_epi32(_mm256_castsi256_si128(acc[r]), _mm256_extracti128_si256(acc[r], 1)) };
+                half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+                half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+                std::int32_t result{ _mm_cvtsi128_si32(half) };
+                for (size_t tail{ col }; tail < n_cols; tail++)
+                {
+                    result += static_cast<std::int32_t>(x[tail]) * static_cast<std::int32_t>(w[r * n_cols + tail]);
+                }
+                dst[r] = result;
+            }
+        }
+
+        SIMD_TARGET_AVX2 void matrixVectorU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_rows, const size_t n_cols)
+        {
+            size_t row{ 0 };
+            for (; row + 4 <= n_rows; row += 4)
+            {
+                dotRowsU8I8<4>(dst + row, x, w + row * n_cols, n_cols);
+            }
+            for (; row < n_rows; row++)
+            {
+                dotRowsU8I8<1>(dst + row, x, w + row * n_cols, n_cols);
+            }
+        }
+
+        SIMD_TARGET_AVX2 const char* findNth(const char* begin, const char* end, const char c, size_t n)
+        {
+            if (n == 0)
+                return begin;
+            __m256i target{ _mm256_set1_epi8(c) };
+            for (; end - begin >= 32; begin += 32)
+            {
+                unsigned int mask{ static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)), target))) };
+                size_t count{ static_cast<size_t>(std::popcount(mask)) };
+                if (count >= n)
+                    return begin + nthSetBit(mask, n);
+                n -= count;
+            }
+            return sse2_impl::findNth(begin, end, c, n);
+        }
+
+#define SIMD_TARGET SIMD_TARGET_AVX2
+#include "simd_math.inl"
+#undef SIMD_TARGET
+
+        constexpr KernelSet kernels{
+            { add<F32>, subtract<F32>, multiply<F32>, scale<F32>, addScalar<F32>, dot<F32>, sum<F32>,
+                transcendentals<F32, simd::Accuracy::accurate>, transcendentals<F32, simd::Accuracy::fast> },
+            { add<F64>, subtract<F64>, multiply<F64>, scale<F64>, addScalar<F64>, dot<F64>, sum<F64>,
+                transcendentals<F64, simd::Accuracy::accurate>, transcendentals<F64, simd::Accuracy::fast> },
+            matrixVectorU8I8,
+            findNth
+        };
+    }
+
+    //GCC 12 reports the placeholder operand of its own _mm512_undefined_* as uninitialized in max, min and shifts
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    namespace avx512_impl
+    {
+        struct F64
+        {
+            using Scalar = double;
+            using Vector = __m512d;
+            using Mask = __mmask8;
+            static constexpr size_t width{ 8 };
+
+            SIMD_TARGET_AVX512 static Vector load(const double* p) { return _mm512_loadu_pd(p); }
+            SIMD_TARGET_AVX512 static void store(double* p, const Vector x) { _mm512_storeu_pd(p, x); }
+            SIMD_TARGET_AVX512 static Vector set1(const double x) { return _mm512_set1_pd(x); }
+            SIMD_TARGET_AVX512 static Vector zero() { return _mm512_setzero_pd(); }
+            SIMD_TARGET_AVX512 static Vector add(const Vector a, const Vector b) { return _mm512_add_pd(a, b); }
+            SIMD_TARGET_AVX512 static Vector sub(const Vector a, const Vector b) { return _mm512_sub_pd(a, b); }
+            SIMD_TARGET_AVX512 static Vector mul(const Vector a, const Vector b) { return _mm512_mul_pd(a, b); }
+            SIMD_TARGET_AVX512 static Vector fmadd(const Vector a, const Vector b, const Vector acc) { return _mm512_fmadd_pd(a, b, acc); }
+            SIMD_TARGET_AVX512 static Vector div(const Vector a, const Vector b) { return _mm512_div_pd(a, b); }
+            SIMD_TARGET_AVX512 static Vector min(const Vector a, const Vector b) { return _mm512_min_pd(a, b); }
+            SIMD_TARGET_AVX512 static Vector max(const Vector a, const Vector b) { return _mm512_max_pd(a, b); }
+            SIMD_TARGET_AVX512 static Vector abs(const Vector x) { return _mm512_abs_pd(x); }
+            SIMD_TARGET_AVX512 static Vector copySign(const Vector magnitude, const Vector sign) { return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(abs(magnitude)), _mm512_and_si512(_mm512_castpd_si512(sign), _mm512_set1_epi64(INT64_MIN)))); }
+            SIMD_TARGET_AVX512 static Mask less(const Vector a, const Vector b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+            SIMD_TARGET_AVX512 static Mask isNan(const Vector x) { return _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q); }
+            SIMD_TARGET_AVX512 static Vector blend(const Mask mask, const Vector if_true, const Vector if_false) { return _mm512_mask_blend_pd(mask, if_false, if_true); }
+            SIMD_TARGET_AVX512 static Vector scaleByPow2(const Vector x, const Vector n) { return _mm512_castsi512_pd(_mm512_add_epi64(_mm512_castpd_si512(x), _mm512_slli_epi64(_mm512_castpd_si512(n), 52))); }
+
+            SIMD_TARGET_AVX512 static double horizontalSum(const Vector x)
+            {
+                double lanes[8]{};
+                _mm512_storeu_pd(lanes, x);
+                return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+            }
+        };
+
+        struct F32
+        {
+            using Scalar = float;
+            using Vector = __m512;
+            using Mask = __mmask16;
+            static constexpr size_t width{ 16 };
+
+            SIMD_TARGET_AVX512 static Vector load(const float* p) { return _mm512_loadu_ps(p); }
+            SIMD_TARGET_AVX512 static void store(float* p, const Vector x) { _mm512_storeu_ps(p, x); }
+            SIMD_TARGET_AVX512 static Vector set1(const float x) { return _mm512_set1_ps(x); }
+            SIMD_TARGET_AVX512 static Vector zero() { return _mm512_setzero_ps(); }
+            SIMD_TARGET_AVX512 static Vector add(const Vector a, const Vector b) { return _mm512_add_ps(a, b); }
+            SIMD_TARGET_AVX512 static Vector sub(const Vector a, const Vector b) { return _mm512_sub_ps(a, b); }
+            SIMD_TARGET_AVX512 static Vector mul(const Vector a, const Vector b) { return _mm512_mul_ps(a, b); }
+            SIMD_TARGET_AVX512 static Vector fmadd(const Vector a, const Vector b, const Vector acc) { return _mm512_fmadd_ps(a, b, acc); }
+            SIMD_TARGET_AVX512 static Vector div(const Vector a, const Vector b) { return _mm512_div_ps(a, b); }
+            SIMD_TARGET_AVX512 static Vector min(const Vector a, const Vector b) { return _mm512_min_ps(a, b); }
+            SIMD_TARGET_AVX512 static Vector max(const Vector a, const Vector b) { return _mm512_max_ps(a, b); }
+            SIMD_TARGET_AVX512 static Vector abs(const Vector x) { return _mm512_abs_ps(x); }
+            SIMD_TARGET_AVX512 static Vector copySign(const Vector magnitude, const Vector sign) { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(abs(magnitude)), _mm512_and_si512(_mm512_castps_si512(sign), _mm512_set1_epi32(INT32_MIN)))); }
+            SIMD_TARGET_AVX512 static Mask less(const Vector a, const Vector b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+            SIMD_TARGET_AVX512 static Mask isNan(const Vector x) { return _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q); }
+            SIMD_TARGET_AVX512 static Vector blend(const Mask mask, const Vector if_true, const Vector if_false) { return _mm512_mask_blend_ps(mask, if_false, if_true); }
+            SIMD_TARGET_AVX512 static Vector scaleByPow2(const Vector x, const Vector n) { return _mm512_castsi512_ps(_mm512_add_epi32(_mm512_castps_si512(x), _mm512_slli_epi32(_mm512_castps_si512(n), 23))); }
+
+            SIMD_TARGET_AVX512 static float horizontalSum(const Vector x)
+            {
+                float lanes[16]{};
+                _mm512_storeu_ps(lanes, x);
+                for (size_t step{ 8 }; step > 0; step /= 2)
+                {
+                    for (size_t i{ 0 }; i < step; i++)
+                    {
+                        lanes[i] += lanes[i + step];
+                    }
+                }
+                return lanes[0];
+            }
+        };
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 void add(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::add(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] + b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 void subtract(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::sub(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] - b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 void multiply(T* dst, const T* a, const T* b, const size_t n)
+        {
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::mul(V::load(a + i), V::load(b + i)));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] * b[i];
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 void scale(T* dst, const T* a, const T multiplier, const size_t n)
+        {
+            typename V::Vector m{ V::set1(multiplier) };
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::mul(V::load(a + i), m));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] * multiplier;
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 void addScalar(T* dst, const T* a, const T add_me, const size_t n)
+        {
+            typename V::Vector s{ V::set1(add_me) };
+            size_t i{ 0 };
+            for (; i + V::width <= n; i += V::width)
+            {
+                V::store(dst + i, V::add(V::load(a + i), s));
+            }
+            for (; i < n; i++)
+            {
+                dst[i] = a[i] + add_me;
+            }
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 T dot(const T* a, const T* b, const size_t n)
+        {
+            constexpr size_t w{ V::width };
+            typename V::Vector acc0{ V::zero() };
+            typename V::Vector acc1{ V::zero() };
+            typename V::Vector acc2{ V::zero() };
+            typename V::Vector acc3{ V::zero() };
+            size_t i{ 0 };
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);
+                acc1 = V::fmadd(V::load(a + i + w), V::load(b + i + w), acc1);
+                acc2 = V::fmadd(V::load(a + i + 2 * w), V::load(b + i + 2 * w), acc2);
+                acc3 = V::fmadd(V::load(a + i + 3 * w), V::load(b + i + 3 * w), acc3);
+            }
+            for (; i + w <= n; i += w)
+            {
+                acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);
+            }
+            T result{ V::horizontalSum(V::add(V::add(acc0, acc1), V::add(acc2, acc3))) };
+            for (; i < n; i++)
+            {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        template <typename V, typename T = typename V::Scalar>
+        SIMD_TARGET_AVX512 T sum(const T* a, const size_t n)
+        {
+            constexpr size_t w{ V::width };
+            typename V::Vector acc0{ V::zero() };
+            typename V::Vector acc1{ V::zero() };
+            typename V::Vector acc2{ V::zero() };
+            typename V::Vector acc3{ V::zero() };
+            size_t i{ 0 };
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                acc0 = V::add(acc0, V::load(a + i));
+                acc1 = V::add(acc1, V::load(a + i + w));
+                acc2 = V::add(acc2, V::load(a + i + 2 * w));
+                acc3 = V::add(acc3, V::load(a + i + 3 * w));
+            }
+            for (; i + w <= n; i += w)
+            {
+                acc0 = V::add(acc0, V::load(a + i));
+            }
+            T result{ V::horizontalSum(V::add(V::add(acc0, acc1), V::add(acc2, acc3))) };
+            for (; i < n; i++)
+            {
+                result += a[i];
+            }
+            return result;
+        }
+
+        //vpdpbusd multiplies unsigned by signed bytes and adds each group of four products straight into 32 bits.
+        //The last partial block is read through a byte mask, so short rows never fall back to scalar code
+        template <size_t R>
+        SIMD_TARGET_AVX512_VNNI void dotRowsU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_cols)
+        {
+            __m512i acc[R]{};
+            for (size_t col{ 0 }; col < n_cols; col += 64)
+            {
+                size_t n_block{ std::min<size_t>(64, n_cols - col) };
+                __mmask64 mask{ n_block == 64 ? ~__mmask64{ 0 } : (__mmask64{ 1 } << n_block) - 1 };
+                __m512i x_block{ _mm512_maskz_loadu_epi8(mask, x + col) };
+                for (size_t r{ 0 }; r < R; r++)
+                {
+                    acc[r] = _mm512_dpbusd_epi32(acc[r], x_block, _mm512_maskz_loadu_epi8(mask, w + r * n_cols + col));
+                }
+            }
+            for (size_t r{ 0 }; r < R; r++)
+            {
+                dst[r] = _mm512_reduce_add_epi32(acc[r]);
+            }
+        }
+
+        SIMD_TARGET_AVX512_VNNI void matrixVectorU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_rows, const size_t n_cols)
+        {
+            size_t row{ 0 };
+            for (; row + 4 <= n_rows; row += 4)
+            {
+                dotRowsU8I8<4>(dst + row, x, w + row * n_cols, n_cols);
+            }
+            for (; row < n_rows; row++)
+            {
+                dotRowsU8I8<1>(dst + row, x, w + row * n_cols, n_cols);
+            }
+        }
+
+#define SIMD_TARGET SIMD_TARGET_AVX512
+#include "simd_math.inl"
+#undef SIMD_TARGET
+
+        constexpr KernelSet kernels{
+            { add<F32>, subtract<F32>, multiply<F32>, scale<F32>, addScalar<F32>, dot<F32>, sum<F32>,
+                transcendentals<F32, simd::Accuracy::accurate>, transcendentals<F32, simd::Accuracy::fast> },
+            { add<F64>, subtract<F64>, multiply<F64>, scale<F64>, addScalar<F64>, dot<F64>, sum<F64>,
+                transcendentals<F64, simd::Accuracy::accurate>, transcendentals<F64, simd::Accuracy::fast> },
+            //Without VNNI, AVX-512 widens to 16 bits exactly like AVX2 does
+            avx2_impl::matrixVectorU8I8,
+            //Byte compares need AVX-512BW, which plain AVX-512F does not promise
+            avx2_impl::findNth
+        };
+
+        //Same floating-point kernels, integer products with vpdpbusd
+        constexpr KernelSet vnni_kernels{ kernels.f32, kernels.f64, matrixVectorU8I8, kernels.findNth };
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    void cpuid(const int leaf, const int subleaf, unsigned int (&regs)[4])
+    {
+#if defined(_MSC_VER)
+        int info[4]{};
+        __cpuidex(info, leaf, subleaf);
+        for (size_t i{ 0 }; i < 4; i++)
+        {
+            regs[i] = static_cast<unsigned int>(info[i]);
+        }
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    //Reads XCR0, which tells whether the OS saves the wide register state on context switches
+    unsigned long long xgetbv()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int eax{ 0 };
+        unsigned int edx{ 0 };
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    const KernelSet& kernelsFor(const simd::InstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+#ifdef SIMD_X86
+        case simd::InstructionSet::sse2:
+            return sse2_impl::kernels;
+        case simd::InstructionSet::avx2:
+            return avx2_impl::kernels;
+        case simd::InstructionSet::avx512:
+            return avx512_impl::kernels;
+        case simd::InstructionSet::avx512_vnni:
+            return avx512_impl::vnni_kernels;
+#endif
+        default:
+            return scalar_impl::kernels;
+        }
+    }
+
+    std::atomic<const KernelSet*>& activeKernels()
+    {
+        static std::atomic<const KernelSet*> kernels{ &kernelsFor(simd::detectInstructionSet()) };
+        return kernels;
+    }
+
+    std::atomic<simd::FloatMode> g_float_mode{ simd::FloatMode::strict };
+}
+
+namespace simd
+{
+    InstructionSet detectInstructionSet()
+    {
+#ifdef SIMD_X86
+        unsigned int leaf1[4]{};
+        unsigned int leaf7[4]{};
+        cpuid(0, 0, leaf1);
+        unsigned int max_leaf{ leaf1[0] };
+        cpuid(1, 0, leaf1);
+        if (max_leaf >= 7)
+            cpuid(7, 0, leaf7);
+
+        bool has_sse2{ (leaf1[3] & (1u << 26)) != 0 };
+        bool has_osxsave{ (leaf1[2] & (1u << 27)) != 0 };
+        bool has_avx{ (leaf1[2] & (1u << 28)) != 0 };
+        bool has_fma{ (leaf1[2] & (1u << 12)) != 0 };
+        bool has_avx2{ (leaf7[1] & (1u << 5)) != 0 };
+        bool has_avx512f{ (leaf7[1] & (1u << 16)) != 0 };
+        bool has_avx512bw{ (leaf7[1] & (1u << 30)) != 0 };
+        bool has_avx512vnni{ (leaf7[2] & (1u << 11)) != 0 };
+
+        unsigned long long xcr0{ has_osxsave ? xgetbv() : 0 };
+        bool os_ymm{ (xcr0 & 0x6) == 0x6 };
+        bool os_zmm{ (xcr0 & 0xE6) == 0xE6 };
+
+        if (has_avx512f && has_avx512bw && has_avx512vnni && os_zmm)
+            return InstructionSet::avx512_vnni;
+        if (has_avx512f && os_zmm)
+            return InstructionSet::avx512;
+        if (has_avx && has_avx2 && has_fma && os_ymm)
+            return InstructionSet::avx2;
+        if (has_sse2)
+            return InstructionSet::sse2;
+#endif
+        return InstructionSet::scalar;
+    }
+
+    InstructionSet instructionSet()
+    {
+        const KernelSet* kernels{ activeKernels().load(std::memory_order_relaxed) };
+        for (InstructionSet instruction_set : { InstructionSet::avx512_vnni, InstructionSet::avx512, InstructionSet::avx2, InstructionSet::sse2 })
+        {
+            if (kernels == &kernelsFor(instruction_set))
+                return instruction_set;
+        }
+        return InstructionSet::scalar;
+    }
+
+    void setInstructionSet(const InstructionSet instruction_set)
+    {
+        if (static_cast<int>(instruction_set) > static_cast<int>(detectInstructionSet()))
+            throw std::invalid_argument("Instruction set is not supported on this machine!");
+
+        activeKernels().store(&kernelsFor(instruction_set), std::memory_order_relaxed);
+    }
+
+    FloatMode floatMode()
+    {
+        return g_float_mode.load(std::memory_order_relaxed);
+    }
+
+    void setFloatMode(const FloatMode float_mode)
+    {
+        g_float_mode.store(float_mode, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void add(T* dst, const T* a, const T* b, const size_t n)
+    {
+        select<T>(*activeKernels().load(std::memory_order_relaxed)).add(dst, a, b, n);
+    }
+
+    template <typename T>
+    void subtract(T* dst, const T* a, const T* b, const size_t n)
+    {
+        select<T>(*activeKernels().load(std::memory_order_relaxed)).subtract(dst, a, b, n);
+    }
+
+    template <typename T>
+    void multiply(T* dst, const T* a, const T* b, const size_t n)
+    {
+        select<T>(*activeKernels().load(std::memory_order_relaxed)).multiply(dst, a, b, n);
+    }
+
+    template <typename T>
+    void scale(T* dst, const T* a, const std::type_identity_t<T> multiplier, const size_t n)
+    {
+        select<T>(*activeKernels().load(std::memory_order_relaxed)).scale(dst, a, multiplier, n);
+    }
+
+    template <typename T>
+    void addScalar(T* dst, const T* a, const std::type_identity_t<T> add_me, const size_t n)
+    {
+        select<T>(*activeKernels().load(std::memory_order_relaxed)).addScalar(dst, a, add_me, n);
+    }
+
+    template <typename T>
+    T dot(const T* a, const T* b, const size_t n)
+    {
+        if (floatMode() == FloatMode::strict)
+            return strictDot(a, b, n);
+
+        return select<T>(*activeKernels().load(std::memory_order_relaxed)).dot(a, b, n);
+    }
+
+    template <typename T>
+    T sum(const T* a, const size_t n)
+    {
+        if (floatMode() == FloatMode::strict)
+            return strictSum(a, n);
+
+        return select<T>(*activeKernels().load(std::memory_order_relaxed)).sum(a, n);
+    }
+
+    void matrixVectorU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_rows, const size_t n_cols)
+    {
+        activeKernels().load(std::memory_order_relaxed)->matrixVectorU8I8(dst, x, w, n_rows, n_cols);
+    }
+
+    namespace
+    {
+        template <typename T>
+        const Transcendentals<T>& transcendentals(const Accuracy accuracy)
+        {
+            const Kernels<T>& kernels{ select<T>(*activeKernels().load(std::memory_order_relaxed)) };
+            return accuracy == Accuracy::fast ? kernels.fast : kernels.accurate;
+        }
+    }
+
+    template <typename T>
+    void exp(T* dst, const T* a, const size_t n, const Accuracy accuracy)
+    {
+        transcendentals<T>(accuracy).exp(dst, a, n);
+    }
+
+    template <typename T>
+    void tanh(T* dst, const T* a, const size_t n, const Accuracy accuracy)
+    {
+        transcendentals<T>(accuracy).tanh(dst, a, n);
+    }
+
+    template <typename T>
+    void sigmoid(T* dst, const T* a, const size_t n, const Accuracy accuracy)
+    {
+        transcendentals<T>(accuracy).sigmoid(dst, a, n);
+    }
+
+    template <typename T>
+    void softplus(T* dst, const T* a, const size_t n, const Accuracy accuracy)
+    {
+        transcendentals<T>(accuracy).softplus(dst, a, n);
+    }
+
+    template <typename T>
+    void softplusWithDer(T* dst, T* dst_der, const T* a, const size_t n, const Accuracy accuracy)
+    {
+        transcendentals<T>(accuracy).softplusWithDer(dst, dst_der, a, n);
+    }
+
+    template void add(float*, const float*, const float*, const size_t);
+    template void add(double*, const double*, const double*, const size_t);
+    template void subtract(float*, const float*, const float*, const size_t);
+    template void subtract(double*, const double*, const double*, const size_t);
+    template void multiply(float*, const float*, const float*, const size_t);
+    template void multiply(double*, const double*, const double*, const size_t);
+    template void scale(float*, const float*, const float, const size_t);
+    template void scale(double*, const double*, const double, const size_t);
+    template void addScalar(float*, const float*, const float, const size_t);
+    template void addScalar(double*, const double*, const double, const size_t);
+    template float dot(const float*, const float*, const size_t);
+    template double dot(const double*, const double*, const size_t);
+    template float sum(const float*, const size_t);
+    template double sum(const double*, const size_t);
+    template void exp(float*, const float*, const size_t, const Accuracy);
+    template void exp(double*, const double*, const size_t, const Accuracy);
+    template void tanh(float*, const float*, const size_t, const Accuracy);
+    template void tanh(double*, const double*, const size_t, const Accuracy);
+    template void sigmoid(float*, const float*, const size_t, const Accuracy);
+    template void sigmoid(double*, const double*, const size_t, const Accuracy);
+    template void softplus(float*, const float*, const size_t, const Accuracy);
+    template void softplus(double*, const double*, const size_t, const Accuracy);
+    template void softplusWithDer(float*, float*, const float*, const size_t, const Accuracy);
+    template void softplusWithDer(double*, double*, const double*, const size_t, const Accuracy);
+}
+
+namespace text_scan
+{
+    const char* findNth(const char* begin, const char* end, const char c, const size_t n)
+    {
+        return activeKernels().load(std::memory_order_relaxed)->findNth(begin, end, c, n);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace simd
+{
+    enum class InstructionSet
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512,
+        //AVX-512 plus the byte dot product instructions, used by the quantized kernels
+        avx512_vnni
+    };
+
+    //strict keeps every result bit-identical to the plain sequential loops,
+    //fast lets reductions reassociate and use fused multiply-add
+    enum class FloatMode
+    {
+        strict,
+        fast
+    };
+
+    //accurate keeps the transcendental kernels within a few ulp of the exact result,
+    //fast uses shorter polynomials whose error is bounded but well above rounding (fine for inference)
+    enum class Accuracy
+    {
+        accurate,
+        fast
+    };
+
+    InstructionSet detectInstructionSet();
+    InstructionSet instructionSet();
+    void setInstructionSet(const InstructionSet instruction_set);
+    FloatMode floatMode();
+    void setFloatMode(const FloatMode float_mode);
+
+    //Element-wise kernels; dst may alias a or b. Instantiated for float and double.
+    template <typename T>
+    void add(T* dst, const T* a, const T* b, const size_t n);
+    template <typename T>
+    void subtract(T* dst, const T* a, const T* b, const size_t n);
+    template <typename T>
+    void multiply(T* dst, const T* a, const T* b, const size_t n);
+    template <typename T>
+    void scale(T* dst, const T* a, const std::type_identity_t<T> multiplier, const size_t n);
+    template <typename T>
+    void addScalar(T* dst, const T* a, const std::type_identity_t<T> add_me, const size_t n);
+
+    //Reductions, accumulated in T
+    template <typename T>
+    T dot(const T* a, const T* b, const size_t n);
+    template <typename T>
+    T sum(const T* a, const size_t n);
+
+    //Element-wise transcendental functions; dst may alias a. Every element takes the same vector code path,
+    //so results do not depend on n or on how a range is split. Instantiated for float and double.
+    template <typename T>
+    void exp(T* dst, const T* a, const size_t n, const Accuracy accuracy = Accuracy::accurate);
+    template <typename T>
+    void tanh(T* dst, const T* a, const size_t n, const Accuracy accuracy = Accuracy::accurate);
+    template <typename T>
+    void sigmoid(T* dst, const T* a, const size_t n, const Accuracy accuracy = Accuracy::accurate);
+    //Evaluated as max(x, 0) + log(1 + exp(-|x|)), which cannot overflow
+    template <typename T>
+    void softplus(T* dst, const T* a, const size_t n, const Accuracy accuracy = Accuracy::accurate);
+    //softplus into dst and its derivative, the logistic function, into dst_der from a single exp per element.
+    //dst may alias a; dst_der may not.
+    template <typename T>
+    void softplusWithDer(T* dst, T* dst_der, const T* a, const size_t n, const Accuracy accuracy = Accuracy::accurate);
+
+    //Quantized matrix-vector product: dst[row] = sum over col of x[col] * w[row * n_cols + col], with unsigned
+    //8-bit x and signed 8-bit w, accumulated exactly in 32 bits (|w| <= 127 keeps that safe up to n_cols = 66000)
+    void matrixVectorU8I8(std::int32_t* dst, const std::uint8_t* x, const std::int8_t* w, const size_t n_rows, const size_t n_cols);
+
+}
\ No newline at end of file
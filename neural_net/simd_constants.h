@@ -0,0 +1,64 @@
+#pragma once
+
+namespace simd
+{
+    //Coefficients of the vector transcendentals in simd_math.inl, highest power first.
+    //exp splits ln2 in two (Cody-Waite) so that x - n ln2 stays exact, then sums the Taylor series of exp(r) for |r| <= ln2 / 2.
+    //tanh near zero is the Cephes approximation, log1p the fdlibm log kernel. The fast sets are cut to a relative
+    //error of a few 1e-6, which the accurate sets keep below the rounding error of T.
+    //header_export writes the accurate sets into generated headers, so exported networks track any change here.
+    template <typename T>
+    struct MathConstants;
+
+    template <>
+    struct MathConstants<double>
+    {
+        //1.5 * 2^52: adding it rounds to an integer that lands in the low mantissa bits
+        static constexpr double round_magic{ 6755399441055744.0 };
+        //The range where 2^n exp(r) is a normal number; results beyond it are taken as infinity or zero
+        static constexpr double exp_max{ 709.78 };
+        static constexpr double exp_min{ -708.0 };
+        static constexpr double log2e{ 1.4426950408889634 };
+        static constexpr double ln2{ 0.6931471805599453 };
+        static constexpr double exp_ln2_hi{ 6.93145751953125e-1 };
+        static constexpr double exp_ln2_lo{ 1.42860682030941723212e-6 };
+        static constexpr double exp_accurate[]{ 1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0,
+            1.0 / 40320.0, 1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0 };
+        static constexpr double exp_fast[]{ 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0 };
+
+        static constexpr double tanh_small{ 0.625 };
+        static constexpr double tanh_p[]{ -9.64399179425052238628e-1, -9.92877231001918586564e1, -1.61468768441708447952e3 };
+        static constexpr double tanh_q[]{ 1.0, 1.12811678491632931402e2, 2.23548839060100448583e3, 4.84406305325125486048e3 };
+
+        static constexpr double sqrt2{ 1.4142135623730951 };
+        static constexpr double log_ln2_hi{ 6.93147180369123816490e-1 };
+        static constexpr double log_ln2_lo{ 1.90821492927058770002e-10 };
+        static constexpr double log_accurate[]{ 1.479819860511658591e-1, 1.531383769920937332e-1, 1.818357216161805012e-1,
+            2.222219843214978396e-1, 2.857142874366239149e-1, 3.999999999940941908e-1, 6.666666666666735130e-1 };
+        static constexpr double log_fast[]{ 3.999999999940941908e-1, 6.666666666666735130e-1 };
+    };
+
+    template <>
+    struct MathConstants<float>
+    {
+        static constexpr float round_magic{ 12582912.0f };
+        static constexpr float exp_max{ 88.72f };
+        static constexpr float exp_min{ -86.5f };
+        static constexpr float log2e{ 1.44269504f };
+        static constexpr float ln2{ 0.693147181f };
+        static constexpr float exp_ln2_hi{ 0.693359375f };
+        static constexpr float exp_ln2_lo{ -2.12194440e-4f };
+        static constexpr float exp_accurate[]{ 1.0f / 5040.0f, 1.0f / 720.0f, 1.0f / 120.0f, 1.0f / 24.0f, 1.0f / 6.0f, 0.5f, 1.0f, 1.0f };
+        static constexpr float exp_fast[]{ 1.0f / 120.0f, 1.0f / 24.0f, 1.0f / 6.0f, 0.5f, 1.0f, 1.0f };
+
+        static constexpr float tanh_small{ 0.625f };
+        static constexpr float tanh_p[]{ -5.70498872745e-3f, 2.06390887954e-2f, -5.37397155531e-2f, 1.33314422036e-1f, -3.33332819422e-1f };
+        static constexpr float tanh_q[]{ 1.0f };
+
+        static constexpr float sqrt2{ 1.41421356f };
+        static constexpr float log_ln2_hi{ 6.9313812256e-1f };
+        static constexpr float log_ln2_lo{ 9.0580006145e-6f };
+        static constexpr float log_accurate[]{ 2.4279078841e-1f, 2.8498786688e-1f, 4.0000972152e-1f, 6.6666662693e-1f };
+        static constexpr float log_fast[]{ 4.0000972152e-1f, 6.6666662693e-1f };
+    };
+}
@@ -0,0 +1,175 @@
+//Vector transcendentals, written once against the F64/F32 traits interface.
+//simd.cpp includes this inside every instruction set namespace with SIMD_TARGET defined as that set's target attribute.
+
+template <typename V, typename T, size_t N>
+SIMD_TARGET typename V::Vector polynomial(const typename V::Vector x, const T (&coefficients)[N])
+{
+    typename V::Vector result{ V::set1(coefficients[0]) };
+    for (size_t i{ 1 }; i < N; i++)
+    {
+        result = V::fmadd(result, x, V::set1(coefficients[i]));
+    }
+    return result;
+}
+
+//exp(x) = 2^n exp(r) with n = round(x / ln2) and |r| <= ln2 / 2
+template <typename V, simd::Accuracy A>
+SIMD_TARGET typename V::Vector expVector(const typename V::Vector x)
+{
+    using T = typename V::Scalar;
+    using C = MathConstants<T>;
+    typename V::Vector clamped{ V::min(V::max(x, V::set1(C::exp_min)), V::set1(C::exp_max)) };
+    typename V::Vector n_shifted{ V::fmadd(clamped, V::set1(C::log2e), V::set1(C::round_magic)) };
+    typename V::Vector n{ V::sub(n_shifted, V::set1(C::round_magic)) };
+
+    typename V::Vector p{};
+    if constexpr (A == simd::Accuracy::accurate)
+    {
+        typename V::Vector r{ V::fmadd(n, V::set1(-C::exp_ln2_hi), clamped) };
+        r = V::fmadd(n, V::set1(-C::exp_ln2_lo), r);
+        p = polynomial<V>(r, C::exp_accurate);
+    }
+    else
+    {
+        p = polynomial<V>(V::fmadd(n, V::set1(-C::ln2), clamped), C::exp_fast);
+    }
+
+    typename V::Vector result{ V::scaleByPow2(p, n_shifted) };
+    result = V::blend(V::less(V::set1(C::exp_max), x), V::set1(std::numeric_limits<T>::infinity()), result);
+    result = V::blend(V::less(x, V::set1(C::exp_min)), V::zero(), result);
+    return V::blend(V::isNan(x), x, result);
+}
+
+//log(1 + e) for e in [0, 1], after the fdlibm log1p: 1 + e = 2^k (1 + f) with 1 + f in [sqrt(2) / 2, sqrt(2)],
+//and log(1 + f) = f - f^2 / 2 + s (f^2 / 2 + R(s^2)) with s = f / (2 + f)
+template <typename V, simd::Accuracy A>
+SIMD_TARGET typename V::Vector log1pVector(const typename V::Vector e)
+{
+    using T = typename V::Scalar;
+    using C = MathConstants<T>;
+    typename V::Vector one{ V::set1(T{ 1 }) };
+    typename V::Vector half{ V::set1(T{ 0.5 }) };
+    typename V::Vector u{ V::add(one, e) };
+    typename V::Mask halve{ V::less(V::set1(C::sqrt2), u) };
+    typename V::Vector k{ V::blend(halve, one, V::zero()) };
+    typename V::Vector f{ V::sub(V::blend(halve, V::mul(u, half), u), one) };
+
+    typename V::Vector s{ V::div(f, V::add(V::set1(T{ 2 }), f)) };
+    typename V::Vector z{ V::mul(s, s) };
+    typename V::Vector hfsq{ V::mul(half, V::mul(f, f)) };
+
+    typename V::Vector r{};
+    typename V::Vector low{};
+    if constexpr (A == simd::Accuracy::accurate)
+    {
+        r = V::mul(z, polynomial<V>(z, C::log_accurate));
+        //u - 1 is exact, so this is what rounding 1 + e lost
+        typename V::Vector c{ V::div(V::sub(e, V::sub(u, one)), u) };
+        low = V::fmadd(k, V::set1(C::log_ln2_lo), c);
+    }
+    else
+    {
+        r = V::mul(z, polynomial<V>(z, C::log_fast));
+        low = V::mul(k, V::set1(C::log_ln2_lo));
+    }
+
+    typename V::Vector log_f{ V::sub(f, V::sub(hfsq, V::fmadd(s, V::add(hfsq, r), low))) };
+    return V::fmadd(k, V::set1(C::log_ln2_hi), log_f);
+}
+
+//Near zero the accurate mode uses the Cephes approximation, elsewhere 1 - 2 / (exp(2|x|) + 1) with the sign of x
+template <typename V, simd::Accuracy A>
+SIMD_TARGET typename V::Vector tanhVector(const typename V::Vector x)
+{
+    using T = typename V::Scalar;
+    using C = MathConstants<T>;
+    typename V::Vector one{ V::set1(T{ 1 }) };
+    typename V::Vector abs_x{ V::abs(x) };
+    typename V::Vector e{ expVector<V, A>(V::add(abs_x, abs_x)) };
+    typename V::Vector large{ V::sub(one, V::div(V::set1(T{ 2 }), V::add(e, one))) };
+    if constexpr (A == simd::Accuracy::fast)
+        return V::copySign(large, x);
+
+    typename V::Vector z{ V::mul(x, x) };
+    typename V::Vector ratio{ polynomial<V>(z, C::tanh_p) };
+    if constexpr (std::size(C::tanh_q) > 1)
+        ratio = V::div(ratio, polynomial<V>(z, C::tanh_q));
+    typename V::Vector small{ V::fmadd(V::mul(abs_x, z), ratio, abs_x) };
+    return V::copySign(V::blend(V::less(abs_x, V::set1(C::tanh_small)), small, large), x);
+}
+
+template <typename V, simd::Accuracy A>
+SIMD_TARGET typename V::Vector sigmoidVector(const typename V::Vector x)
+{
+    typename V::Vector one{ V::set1(typename V::Scalar{ 1 }) };
+    return V::div(one, V::add(one, expVector<V, A>(V::sub(V::zero(), x))));
+}
+
+//max(x, 0) + log(1 + exp(-|x|)) never passes exp an argument above zero, so large x cannot overflow
+template <typename V, simd::Accuracy A>
+SIMD_TARGET typename V::Vector softplusVector(const typename V::Vector x)
+{
+    typename V::Vector e{ expVector<V, A>(V::sub(V::zero(), V::abs(x))) };
+    return V::add(V::max(x, V::zero()), log1pVector<V, A>(e));
+}
+
+template <typename V, typename V::Vector (*function)(const typename V::Vector), typename T = typename V::Scalar>
+SIMD_TARGET void mapElements(T* dst, const T* a, const size_t n)
+{
+    size_t i{ 0 };
+    for (; i + V::width <= n; i += V::width)
+    {
+        V::store(dst + i, function(V::load(a + i)));
+    }
+    if (i < n)
+    {
+        //The tail is padded to a full vector rather than handed to libm, so every element gets the same approximation
+        T tail[V::width]{};
+        std::copy(a + i, a + n, tail);
+        V::store(tail, function(V::load(tail)));
+        std::copy(tail, tail + (n - i), dst + i);
+    }
+}
+
+//softplus and its derivative, the logistic function, from the one e = exp(-|x|): 1 / (1 + e) for x >= 0 and
+//e / (1 + e) below, so neither side needs a second exp
+template <typename V, simd::Accuracy A>
+SIMD_TARGET void softplusWithDerVector(const typename V::Vector x, typename V::Vector& f_x, typename V::Vector& f_x_der)
+{
+    typename V::Vector one{ V::set1(typename V::Scalar{ 1 }) };
+    typename V::Vector e{ expVector<V, A>(V::sub(V::zero(), V::abs(x))) };
+    typename V::Vector sigmoid_abs{ V::div(one, V::add(one, e)) };
+    f_x = V::add(V::max(x, V::zero()), log1pVector<V, A>(e));
+    f_x_der = V::blend(V::less(x, V::zero()), V::mul(e, sigmoid_abs), sigmoid_abs);
+}
+
+template <typename V, simd::Accuracy A, typename T = typename V::Scalar>
+SIMD_TARGET void softplusWithDer(T* dst, T* dst_der, const T* a, const size_t n)
+{
+    typename V::Vector f_x{};
+    typename V::Vector f_x_der{};
+    size_t i{ 0 };
+    for (; i + V::width <= n; i += V::width)
+    {
+        softplusWithDerVector<V, A>(V::load(a + i), f_x, f_x_der);
+        V::store(dst + i, f_x);
+        V::store(dst_der + i, f_x_der);
+    }
+    if (i < n)
+    {
+        T tail[V::width]{};
+        T tail_der[V::width]{};
+        std::copy(a + i, a + n, tail);
+        softplusWithDerVector<V, A>(V::load(tail), f_x, f_x_der);
+        V::store(tail, f_x);
+        V::store(tail_der, f_x_der);
+        std::copy(tail, tail + (n - i), dst + i);
+        std::copy(tail_der, tail_der + (n - i), dst_der + i);
+    }
+}
+
+template <typename V, simd::Accuracy A>
+constexpr Transcendentals<typename V::Scalar> transcendentals{
+    mapElements<V, expVector<V, A>>, mapElements<V, tanhVector<V, A>>, mapElements<V, sigmoidVector<V, A>>, mapElements<V, softplusVector<V, A>>,
+    softplusWithDer<V, A>
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+
+//Byte scanning for the CSV reader. The vector implementations live with the simd kernels and follow the same
+//simd::setInstructionSet choice.
+namespace text_scan
+{
+    //Position of the n-th occurrence of c in [begin, end), counting from 1; end if there are fewer, begin if n is 0
+    const char* findNth(const char* begin, const char* end, const char c, const size_t n);
+}
@@ -0,0 +1,247 @@
+#include "thread_pool.h"
+#include <exception>
+
+struct ThreadPool::Batch
+{
+    TaskFunction function{};
+    const void* context{};
+    std::atomic<size_t> n_remaining{};
+    std::mutex error_mutex{};
+    std::exception_ptr error{};
+};
+
+namespace
+{
+    //Set while the thread runs a task, which makes loops started from inside it serial
+    thread_local bool t_in_task{ false };
+    thread_local size_t t_thread_limit{ 0 };
+
+    std::atomic<size_t> g_num_threads{ 0 };
+    std::mutex g_pool_mutex{};
+    std::unique_ptr<ThreadPool> g_pool{};
+
+    size_t hardwareThreads()
+    {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+}
+
+void ThreadPool::Queue::push(const Task& task)
+{
+    if (n_ring == QUEUE_CAPACITY)
+    {
+        overflow.push_back(task);
+        return;
+    }
+    ring[(head + n_ring) % QUEUE_CAPACITY] = task;
+    n_ring++;
+}
+
+bool ThreadPool::Queue::popFront(Task& task)
+{
+    if (n_ring == 0)
+        return popBack(task);
+
+    task = ring[head];
+    head = (head + 1) % QUEUE_CAPACITY;
+    n_ring--;
+    return true;
+}
+
+bool ThreadPool::Queue::popBack(Task& task)
+{
+    if (!overflow.empty())
+    {
+        task = overflow.back();
+        overflow.pop_back();
+        return true;
+    }
+    if (n_ring == 0)
+        return false;
+
+    n_ring--;
+    task = ring[(head + n_ring) % QUEUE_CAPACITY];
+    return true;
+}
+
+ThreadPool::ThreadPool(const size_t n_workers)
+{
+    for (size_t i{ 0 }; i < n_workers; i++)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i{ 0 }; i < n_workers; i++)
+    {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_wake_mutex };
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::nWorkers() const
+{
+    return m_workers.size();
+}
+
+bool ThreadPool::tryRunTask(const size_t own_queue, const bool is_worker)
+{
+    Task task{};
+    bool found{ false };
+
+    for (size_t i{ 0 }; i < m_queues.size() && !found; i++)
+    {
+        Queue& queue{ *m_queues[(own_queue + i) % m_queues.size()] };
+        std::lock_guard<std::mutex> lock{ queue.mutex };
+
+        //Own tasks are taken in order, stolen ones from the other end
+        found = is_worker && i == 0 ? queue.popFront(task) : queue.popBack(task);
+    }
+
+    if (!found)
+        return false;
+
+    m_n_queued.fetch_sub(1, std::memory_order_relaxed);
+    runTask(task);
+    return true;
+}
+
+void ThreadPool::runTask(const Task& task)
+{
+    Batch& batch{ *task.batch };
+    bool was_in_task{ t_in_task };
+    t_in_task = true;
+    try
+    {
+        batch.function(batch.context, task.task_idx);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock{ batch.error_mutex };
+        if (!batch.error)
+            batch.error = std::current_exception();
+    }
+    t_in_task = was_in_task;
+
+    //Last access to the batch, which lives on the submitting thread's stack
+    batch.n_remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::workerLoop(const size_t worker_idx)
+{
+    while (true)
+    {
+        if (tryRunTask(worker_idx, true))
+            continue;
+
+        std::unique_lock<std::mutex> lock{ m_wake_mutex };
+        m_wake.wait(lock, [this]() { return m_stop || m_n_queued.load(std::memory_order_relaxed) > 0; });
+        if (m_stop)
+            return;
+    }
+}
+
+void ThreadPool::run(const size_t n_tasks, TaskFunction function, const void* context)
+{
+    if (n_tasks == 0)
+        return;
+
+    Batch batch{};
+    batch.function = function;
+    batch.context = context;
+    batch.n_remaining.store(n_tasks, std::memory_order_relaxed);
+
+    //Task 0 is kept back for the submitting thread, the rest are dealt out over the workers.
+    //The count goes up first so it never drops below zero when a worker takes a task right away.
+    if (!m_queues.empty())
+        m_n_queued.fetch_add(n_tasks - 1, std::memory_order_relaxed);
+    for (size_t i{ 1 }; i < n_tasks; i++)
+    {
+        if (m_queues.empty())
+        {
+            runTask(Task{ &batch, i });
+            continue;
+        }
+
+        Queue& queue{ *m_queues[(i - 1) % m_queues.size()] };
+        std::lock_guard<std::mutex> lock{ queue.mutex };
+        queue.push(Task{ &batch, i });
+    }
+    if (!m_queues.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_wake_mutex };
+        }
+        m_wake.notify_all();
+    }
+
+    runTask(Task{ &batch, 0 });
+
+    //Help with whatever is queued until this batch is done
+    while (batch.n_remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!tryRunTask(0, false))
+            std::this_thread::yield();
+    }
+
+    if (batch.error)
+        std::rethrow_exception(batch.error);
+}
+
+namespace parallel
+{
+    size_t numThreads()
+    {
+        if (t_in_task)
+            return 1;
+        if (t_thread_limit > 0)
+            return t_thread_limit;
+
+        size_t n_threads{ g_num_threads.load(std::memory_order_relaxed) };
+        return n_threads > 0 ? n_threads : hardwareThreads();
+    }
+
+    void setNumThreads(const size_t n_threads)
+    {
+        g_num_threads.store(n_threads, std::memory_order_relaxed);
+
+        //Grow the pool now rather than in the middle of a loop
+        std::lock_guard<std::mutex> lock{ g_pool_mutex };
+        if (g_pool && g_pool->nWorkers() + 1 < n_threads)
+            g_pool.reset();
+    }
+
+    ThreadPool& pool()
+    {
+        std::lock_guard<std::mutex> lock{ g_pool_mutex };
+        if (!g_pool)
+        {
+            size_t n_threads{ std::max(g_num_threads.load(std::memory_order_relaxed), hardwareThreads()) };
+            g_pool = std::make_unique<ThreadPool>(n_threads - 1);
+        }
+        return *g_pool;
+    }
+
+    ThreadLimit::ThreadLimit(const size_t n_threads)
+        : m_previous{ t_thread_limit }
+    {
+        if (n_threads > 0)
+            t_thread_limit = n_threads;
+    }
+
+    ThreadLimit::~ThreadLimit()
+    {
+        t_thread_limit = m_previous;
+    }
+}
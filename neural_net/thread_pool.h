@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Persistent pool of worker threads, each with its own task queue.
+//A worker runs tasks from the front of its own queue and, once that is empty, steals from the back of the others.
+//Each queue is a fixed ring allocated with the pool, so handing out tasks does not allocate; only when a ring is full
+//do further tasks go to an overflow vector, which keeps its capacity afterwards.
+//The thread submitting a batch runs tasks as well until the whole batch has finished.
+class ThreadPool
+{
+public:
+    using TaskFunction = void (*)(const void* context, const size_t task_idx);
+
+private:
+    //Tasks a queue holds before overflowing, well above the few a batch of numThreads() tasks deals to each
+    static constexpr size_t QUEUE_CAPACITY{ 64 };
+
+    struct Batch;
+
+    struct Task
+    {
+        Batch* batch{};
+        size_t task_idx{};
+    };
+
+    //The members are only touched with mutex held
+    struct Queue
+    {
+        std::mutex mutex{};
+        std::array<Task, QUEUE_CAPACITY> ring{};
+        size_t head{};
+        size_t n_ring{};
+        std::vector<Task> overflow{};
+
+        void push(const Task& task);
+        //Overflow tasks count as behind the ring: popBack takes them first, popFront once the ring is empty
+        bool popFront(Task& task);
+        bool popBack(Task& task);
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues{};
+    std::vector<std::thread> m_workers{};
+    std::atomic<size_t> m_n_queued{};
+    std::mutex m_wake_mutex{};
+    std::condition_variable m_wake{};
+    bool m_stop{};
+
+    bool tryRunTask(const size_t own_queue, const bool is_worker);
+    static void runTask(const Task& task);
+    void workerLoop(const size_t worker_idx);
+
+public:
+    explicit ThreadPool(const size_t n_workers);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t nWorkers() const;
+    //Runs function(context, i) for every i in [0, n_tasks) and returns once all have finished.
+    //The first exception thrown by a task is rethrown here after the others have finished.
+    void run(const size_t n_tasks, TaskFunction function, const void* context);
+};
+
+namespace parallel
+{
+    //Threads used by parallel loops started on the calling thread: the innermost ThreadLimit if there is one,
+    //the process-wide count otherwise, and always 1 inside a task so nested loops run serially
+    size_t numThreads();
+    //Process-wide thread count; 0 selects the hardware concurrency. Must not be called while a parallel loop runs.
+    void setNumThreads(const size_t n_threads);
+    ThreadPool& pool();
+
+    //Overrides the thread count for parallel loops started on this thread while it is alive; 0 keeps the current one
+    class ThreadLimit
+    {
+    private:
+        size_t m_previous{};
+
+    public:
+        explicit ThreadLimit(const size_t n_threads);
+        ~ThreadLimit();
+        ThreadLimit(const ThreadLimit&) = delete;
+        ThreadLimit& operator=(const ThreadLimit&) = delete;
+    };
+
+    //Calls function(first, last) on consecutive sub-ranges covering [0, n), one per thread.
+    //Ranges shorter than grain are not split off, so small inputs run on the calling thread without synchronization.
+    //The split depends only on n, grain and the thread count.
+    template <typename F>
+    void forRange(const size_t n, const size_t grain, const F& function)
+    {
+        size_t n_tasks{ std::min(numThreads(), n / std::max<size_t>(grain, 1)) };
+        if (n_tasks <= 1)
+        {
+            function(size_t{ 0 }, n);
+            return;
+        }
+
+        auto task{ [&](const size_t task_idx) { function(n * task_idx / n_tasks, n * (task_idx + 1) / n_tasks); } };
+        pool().run(n_tasks, [](const void* context, const size_t task_idx) { (*static_cast<const decltype(task)*>(context))(task_idx); }, &task);
+    }
+}